@@ -0,0 +1,30 @@
+#ifndef STRAIN_GRAPH_H
+#define STRAIN_GRAPH_H
+
+#include <SDL3/SDL.h>
+#include <rhythm/DifficultyCalculator.h>
+#include <vector>
+
+// A chart's rice and LN strain over time as two overlaid area plots on a
+// dark backdrop. Vertices are rebuilt only when the curve or rect changes
+// and the whole graph is one SDL_RenderGeometry call.
+class StrainGraph {
+public:
+    explicit StrainGraph(SDL_Renderer* renderer);
+
+    void setRect(const SDL_FRect& rect);
+    void setCurve(const StrainCurve& curve);
+    void clear();
+
+    void render();
+private:
+    SDL_Renderer* renderer_ = nullptr;
+    SDL_FRect rect_ = {0, 0, 0, 0};
+    StrainCurve curve_;
+    std::vector<SDL_Vertex> vertices_;
+
+    void rebuild();
+    void addQuad(float x0, float y0Top, float x1, float y1Top, float bottom, SDL_FColor color);
+};
+
+#endif
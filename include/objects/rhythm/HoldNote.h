@@ -28,6 +28,9 @@ public:
             endTime_ = 0.0f;
         }
      }
+    void setEndVisualTime(float t) { endVisualTime_ = t; }
+    float getEndVisualTime() const { return endVisualTime_; }
+
     void setEndY(float y) { endY_ = y; }
     float getEndY() const { return endY_; }
     void setIsHolding(bool holding) { isHolding_ = holding; }
@@ -44,6 +47,7 @@ public:
 private:
     int column_;
     float endTime_ = -1.0f;
+    float endVisualTime_ = 0.0f;
     bool isHolding_ = false;
     bool isFadingOut_ = false;
 
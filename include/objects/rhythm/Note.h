@@ -23,11 +23,13 @@ public:
     void setType(NoteType t) { type = t; }
     void setColumn(int column) { column_ = column; }
     void setSpeedModifier(float speed) { speedModifier_ = speed; }
+    void setVisualTime(float t) { visualTime_ = t; }
 
     float getTime() const { return time; }
     int getColumn() const { return column_; }
     NoteType getType() const { return type; }
     float getSpeedModifier() const { return speedModifier_; }
+    float getVisualTime() const { return visualTime_; }
 
     bool canRenderNote() const { return canRender; }
     bool hasBeenHit() const { return hasBeenHitFlag; }
@@ -52,6 +54,7 @@ private:
     bool despawned = false;
     bool hasBeenHitFlag = false;
     float speedModifier_ = 1.0f;
+    float visualTime_ = 0.0f;
     
     static SDL_Texture* sharedNoteTexture_;
     static SDL_Texture* sharedMineTexture_;
@@ -8,13 +8,14 @@
 #include <future>
 #include <atomic>
 #include <utils/rhythm/ChartUtils.h>
+#include <utils/rhythm/TimingMap.h>
 
 class Conductor {
 public:
     Conductor();
     ~Conductor();
 
-    bool initialize(const std::vector<TimingPoint>& timingPoints, const std::string& audioPath, float playbackRate = 1.0f, float crossfadeDuration = 0.0f, float startTime = 0.0f);
+    bool initialize(const TimingData& timing, const std::string& audioPath, float playbackRate = 1.0f, float crossfadeDuration = 0.0f, float startTime = 0.0f);
     void loadAndPlay(float startTime, float crossfadeDuration = 0.0f);
     
     void play();
@@ -62,7 +63,7 @@ public:
     void setLoopFadeOutDuration(float duration) { loopFadeOutDuration_ = duration; }
     bool isLooping() const { return enableLooping_; }
 private:
-    std::vector<TimingPoint> timingPoints_;
+    TimingMap timingMap_;
     std::string audioPath_;
     
     float songPosition_ = 0.0f;
@@ -113,9 +114,6 @@ private:
     
     void updateBPM();
     void loadAndPlayAsync(float startTime, float crossfadeDuration);
-
-    int findTimingPointIndex(float timeInSeconds) const;
-    float calculateBeats(float startTime, float endTime) const;
 };
 
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "utils/Utils.h"        
 #include "utils/rhythm/ChartUtils.h" 
+#include <span>
 
 struct CalculatedNote {
     int time;
@@ -71,6 +72,22 @@ struct SkillResult {
     double complexity = 0;
 };
 
+// Rice and LN strain of every rating window, for graphs. Sample i covers
+// the window starting at startTime + i * stepMs (ms at the rated rate) and
+// stores the strain as a fraction of `peak` in 1/255 steps.
+struct StrainCurve {
+    int startTime = 0;
+    float stepMs = 0.0f;
+    float peak = 0.0f;
+    std::vector<uint8_t> rice;
+    std::vector<uint8_t> ln;
+
+    bool empty() const { return rice.empty(); }
+    size_t size() const { return rice.size(); }
+    float riceAt(size_t i) const { return rice[i] * peak / 255.0f; }
+    float lnAt(size_t i) const { return ln[i] * peak / 255.0f; }
+};
+
 struct FinalResult {
     std::string title;
     std::string difficulty;
@@ -83,36 +100,189 @@ struct FinalResult {
 
     double minBPM;
     double maxBPM;
+
+    // Only filled when the calculator has strain curves enabled.
+    StrainCurve strain;
+};
+
+// REFERENCE runs every skill loop per window exactly as written. FAST
+// computes the stream, jumpstream, handstream, jack and chordjack terms once
+// per note with float pow approximations and sums windows from prefix sums;
+// ratings stay within DifficultyCalculator::FAST_KERNEL_TOLERANCE (relative)
+// of REFERENCE.
+enum class DifficultyKernels {
+    REFERENCE,
+    FAST
 };
 
 class DifficultyCalculator {
 public:
+    // A window of time-sorted notes; a view into one of the per-kind lists.
+    using NoteSpan = std::span<const CalculatedNote* const>;
+
+    // Bump whenever scoring changes so stored results get recomputed.
+    static constexpr uint32_t ALGORITHM_VERSION = 1;
+    static constexpr double FAST_KERNEL_TOLERANCE = 1e-5;
+    // The LN shields sweep sums per column distance, the pairwise loop per
+    // rice note, so the two only differ by summation order.
+    static constexpr double LN_SHIELDS_SWEEP_TOLERANCE = 1e-12;
+
     DifficultyCalculator(DifficultyConfig cfg = DifficultyConfig());
     
-    FinalResult calculate(ChartData& chartData, float rate = 1.0);
+    // Calculation keeps no state between calls, so one calculator can be
+    // shared by several threads as long as setConfig isn't called meanwhile.
+    FinalResult calculate(const ChartData& chartData, float rate = 1.0) const;
+
+    // One result per entry of `rates`, in the same order. Rate-independent
+    // preparation runs once and the rates are spread over `threadCount`
+    // workers (<= 0 uses every core).
+    std::vector<FinalResult> calculateRates(const ChartData& chartData, const std::vector<float>& rates, int threadCount = 0) const;
+
+    // minRate, minRate + step, ... up to maxRate, rounded to hundredths.
+    static std::vector<float> rateLadder(float minRate = 0.5f, float maxRate = 2.0f, float step = 0.1f);
 
     void setConfig(const DifficultyConfig& cfg);
+    const DifficultyConfig& getConfig() const { return config; }
+
+    void setKernels(DifficultyKernels mode);
+    DifficultyKernels getKernels() const { return kernels; }
+
+    // 4K to 8K charts run through pipelines compiled for their key count;
+    // everything else, or every chart when disabled, takes the generic one.
+    // Both give identical results.
+    void setSpecializedKeyLayouts(bool enabled);
+    bool getSpecializedKeyLayouts() const { return specializedKeyLayouts; }
+
+    // Keep the per-window strain in FinalResult::strain. Off by default;
+    // ratings are the same either way.
+    void setStrainCurves(bool enabled);
+    bool getStrainCurves() const { return strainCurves; }
+
+    // Score LN shields by rescanning every rice note of the window for each
+    // completed hold, the original O(holds x rice) loop, instead of the
+    // per-column sweep. Kept as the reference chart-verify checks the sweep
+    // against; results agree within LN_SHIELDS_SWEEP_TOLERANCE.
+    void setPairwiseLnShields(bool enabled);
+    bool getPairwiseLnShields() const { return pairwiseLnShields; }
 
 private:
+    friend class DifficultyEditSession;
+    friend class DifficultyTuningSet;
+
     DifficultyConfig config;
-    std::vector<CalculatedNote> processedNotes;
+    DifficultyKernels kernels = DifficultyKernels::REFERENCE;
+    bool specializedKeyLayouts = true;
+    bool strainCurves = false;
+    bool pairwiseLnShields = false;
+
+    // Notes with mines dropped and every rate-independent field filled in;
+    // `times` keeps the unscaled note times.
+    struct PreparedNotes {
+        std::vector<float> times;
+        std::vector<CalculatedNote> notes;
+    };
+
+    // One rice kernel's per-note terms and their running totals; entry i
+    // of `sums` covers the first i rice notes.
+    struct RiceKernelTerms {
+        std::vector<float> terms;
+        std::vector<double> sums;
+    };
+
+    struct RiceTermSums {
+        RiceKernelTerms stream;
+        RiceKernelTerms jumpstream;
+        RiceKernelTerms handstream;
+        RiceKernelTerms jack;
+        RiceKernelTerms chordjack;
+    };
 
-    void extractFeatures(ChartData& chartData, float rate);
-    double getBpmAt(int time, const ChartData& chartData, float rate);
+    // Processed notes split by kind, plus the fast kernel sums when enabled.
+    struct NoteLists {
+        std::vector<const CalculatedNote*> rice;
+        std::vector<const CalculatedNote*> lnEvents;
+        std::vector<const CalculatedNote*> lnStarts;
+        RiceTermSums riceTerms;
+    };
+
+    // One window's slice of each list; riceBegin and riceEnd index the
+    // whole rice list for the prefix sums.
+    struct WindowNotes {
+        NoteSpan rice;
+        NoteSpan lnEvents;
+        NoteSpan lnStarts;
+        size_t riceBegin = 0;
+        size_t riceEnd = 0;
+    };
+
+    // Start time and skills of every window that counted, in order, plus
+    // the per-window values aggregate() reads: the stamina average starting
+    // at each window and, with strain curves on, each window's strain.
+    struct WindowSkills {
+        std::vector<double> starts;
+        std::vector<SkillResult> skills;
+        std::vector<double> staminaAverages;
+        std::vector<double> riceStrain;
+        std::vector<double> lnStrain;
+    };
+
+    PreparedNotes prepareNotes(const ChartData& chartData) const;
+    void prepareRange(const NoteData& noteData, size_t begin, size_t end, int keyCount, PreparedNotes& prepared) const;
+    // `Layout` is a KeyLayout from the source file: per-column scratch
+    // storage and hand assignment for one key count.
+    template <typename Layout>
+    std::vector<CalculatedNote> extractFeatures(const PreparedNotes& prepared, const Layout& layout, float rate) const;
+    template <typename Layout>
+    void extractFeatureRange(const PreparedNotes& prepared, std::vector<CalculatedNote>& processedNotes, size_t begin, size_t end, const Layout& layout, float rate) const;
+    template <typename Layout>
+    FinalResult evaluate(const ChartData& chartData, const std::vector<CalculatedNote>& processedNotes, const Layout& layout, float rate) const;
+    template <typename Layout>
+    WindowSkills evaluateWindows(const ChartData& chartData, const std::vector<CalculatedNote>& processedNotes, const Layout& layout, float rate) const;
+    std::vector<double> windowStarts(int startTime, int endTime) const;
+    NoteLists buildNoteLists(const std::vector<CalculatedNote>& processedNotes) const;
+    void collectNotes(const std::vector<CalculatedNote>& processedNotes, NoteLists& lists) const;
+    template <typename Layout>
+    SkillResult evaluateWindow(const NoteLists& lists, const WindowNotes& window, double durSec, double chartBpm, int keyCount, const Layout& layout) const;
+    void refreshWindowTotals(WindowSkills& windows, size_t first, size_t last) const;
+    FinalResult aggregate(const ChartData& chartData, const WindowSkills& windows, int startTime, float rate) const;
+    static bool sameWindowSettings(const DifficultyConfig& a, const DifficultyConfig& b);
+    double getBpmAt(int time, const ChartData& chartData, float rate, size_t& cursor) const;
+
+    // Entry points for DifficultyEditSession and DifficultyTuningSet, which
+    // can't see the layouts.
+    std::vector<CalculatedNote> processNotes(const ChartData& chartData, float rate) const;
+    WindowSkills rateWindows(const ChartData& chartData, const std::vector<CalculatedNote>& processedNotes, float rate) const;
+    void refreshFeatures(const PreparedNotes& prepared, std::vector<CalculatedNote>& processedNotes, size_t begin, size_t end, int keyCount, float rate) const;
+    void refreshWindows(const ChartData& chartData, const NoteLists& lists, WindowSkills& windows, size_t first, size_t last, int endTime, float rate) const;
+    void refreshRiceTerms(const std::vector<const CalculatedNote*>& rice, RiceTermSums& sums, size_t begin, size_t removed, size_t inserted) const;
     
-    double calcStream(const std::vector<const CalculatedNote*>& segment, double durationS);
-    double calcJumpstream(const std::vector<const CalculatedNote*>& segment, double durationS);
-    double calcHandstream(const std::vector<const CalculatedNote*>& segment, double durationS);
-    double calcJack(const std::vector<const CalculatedNote*>& segment, int keyCount, double durationS);
-    double calcChordjack(const std::vector<const CalculatedNote*>& segment, int keyCount, double durationS);
-    double calcTechnical(const std::vector<const CalculatedNote*>& segment);
+    RiceTermSums computeRiceTermSums(const std::vector<const CalculatedNote*>& rice) const;
+    void fillRiceTerms(const std::vector<const CalculatedNote*>& rice, size_t begin, size_t end, RiceTermSums& sums) const;
+    void accumulateRiceTerms(RiceTermSums& sums, size_t from) const;
+
+    double streamSkill(double score, double durationS) const;
+    double jumpstreamSkill(double score, double durationS) const;
+    double handstreamSkill(double score, double durationS) const;
+    double jackSkill(double score, int keyCount, double durationS) const;
+    double chordjackSkill(double score, int keyCount, double durationS) const;
+
+    double calcStream(NoteSpan segment, double durationS) const;
+    double calcJumpstream(NoteSpan segment, double durationS) const;
+    double calcHandstream(NoteSpan segment, double durationS) const;
+    double calcJack(NoteSpan segment, int keyCount, double durationS) const;
+    double calcChordjack(NoteSpan segment, int keyCount, double durationS) const;
+    double calcTechnical(NoteSpan segment) const;
     
-    double calcLnDensity(const std::vector<const CalculatedNote*>& starts, double durationS);
-    double calcLnSpeed(const std::vector<const CalculatedNote*>& starts);
-    double calcLnShields(const std::vector<const CalculatedNote*>& rice, const std::vector<const CalculatedNote*>& lnEvents);
-    double calcLnComplexity(const std::vector<const CalculatedNote*>& lnEvents, int keyCount);
+    double calcLnDensity(NoteSpan starts, double durationS) const;
+    double calcLnSpeed(NoteSpan starts) const;
+    template <typename Layout>
+    double calcLnShields(NoteSpan rice, NoteSpan lnEvents, const Layout& layout) const;
+    double calcLnShieldsPairwise(NoteSpan rice, NoteSpan lnEvents) const;
+    double calcLnComplexity(NoteSpan lnEvents, int keyCount) const;
     
-    double calcStamina(const std::vector<SkillResult>& segments);
+    void refreshStaminaAverages(const std::vector<SkillResult>& segments, std::vector<double>& averages, size_t first, size_t last) const;
+    double staminaFromAverages(const std::vector<double>& averages) const;
+    StrainCurve buildStrainCurve(const WindowSkills& windows, int startTime) const;
 };
 
 #endif
\ No newline at end of file
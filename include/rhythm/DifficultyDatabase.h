@@ -0,0 +1,81 @@
+#ifndef DIFFICULTY_DATABASE_H
+#define DIFFICULTY_DATABASE_H
+
+#include <rhythm/DifficultyCalculator.h>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Difficulty results kept on disk between sessions, keyed by chart hash and
+// rate in hundredths. The file is a header followed by records that are only
+// ever appended, each a fixed-size rating plus its strain curve, if any;
+// everything is indexed in memory on open. Inserts reach the file in batches;
+// the end of a prerating job and close() write whatever is left.
+// A file written by another calculator version, config or kernel mode
+// starts over.
+class DifficultyDatabase {
+public:
+    static constexpr uint32_t VERSION = 2;
+
+    DifficultyDatabase() = default;
+    ~DifficultyDatabase();
+
+    DifficultyDatabase(const DifficultyDatabase&) = delete;
+    DifficultyDatabase& operator=(const DifficultyDatabase&) = delete;
+
+    bool open(const std::string& path, const DifficultyCalculator& calculator);
+    void close();
+
+    // Title and difficulty come from `chart`; they aren't stored.
+    std::optional<FinalResult> find(const ChartData& chart, float rate) const;
+    // Just the rating, without copying the strain curve.
+    std::optional<double> findRawDiff(uint64_t chartHash, float rate) const;
+    bool contains(uint64_t chartHash, float rate) const;
+    void insert(const ChartData& chart, const FinalResult& result);
+    size_t size() const;
+
+    // Rates every chart at each of `rates` that isn't stored yet, one
+    // low-priority worker per core. The charts must stay alive until the job
+    // finishes or stopPrerating() returns.
+    void startPrerating(std::vector<const ChartData*> charts, DifficultyCalculator calculator, std::vector<float> rates);
+    void stopPrerating();
+    bool isPrerating() const;
+
+    static int rateKey(float rate);
+    static uint64_t configHash(const DifficultyCalculator& calculator);
+
+private:
+    struct Key {
+        uint64_t chartHash;
+        int rate;
+        bool operator==(const Key& other) const { return chartHash == other.chartHash && rate == other.rate; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return key.chartHash ^ (static_cast<uint64_t>(key.rate) * 0x9E3779B97F4A7C15ull); }
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<Key, FinalResult, KeyHash> results_;
+    // Encoded records not written yet, guarded by mutex_. The insert that
+    // fills a batch takes it and writes it under fileMutex_ alone, so
+    // lookups and other inserts never wait on the disk.
+    std::string pendingRecords_;
+
+    std::mutex fileMutex_;
+    std::ofstream file_;
+
+    std::vector<std::thread> workers_;
+    std::atomic<bool> stopRequested_{false};
+    std::atomic<int> activeWorkers_{0};
+
+    static std::string encodeRecord(const Key& key, const FinalResult& result);
+    void writeRecords(const std::string& records);
+    void writePendingRecords();
+};
+
+#endif
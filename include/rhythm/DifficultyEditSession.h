@@ -0,0 +1,45 @@
+#ifndef DIFFICULTY_EDIT_SESSION_H
+#define DIFFICULTY_EDIT_SESSION_H
+
+#include <rhythm/DifficultyCalculator.h>
+#include <vector>
+
+// Keeps one chart's rating current while it is being edited. load() does a
+// full calculation and keeps its intermediate state; update() then redoes
+// only the features around the edited time range, the windows and stamina
+// averages that overlap it, and the maxima. With reference kernels results
+// match a full calculate() exactly; fast kernels leave the other windows on
+// their old running totals, so they stay within FAST_KERNEL_TOLERANCE.
+class DifficultyEditSession {
+public:
+    explicit DifficultyEditSession(DifficultyCalculator calculator = DifficultyCalculator(), float rate = 1.0f);
+
+    const FinalResult& load(const ChartData& chart);
+
+    // `chart` is the edited chart. Every note outside [editStartMs,
+    // editEndMs] (chart time, before rate scaling) must be the same as in
+    // the chart last passed in. Falls back to load() for edits that move the
+    // first or last note or change key count or timing.
+    const FinalResult& update(const ChartData& chart, float editStartMs, float editEndMs);
+
+    const FinalResult& getResult() const { return result_; }
+    bool isLoaded() const { return loaded_; }
+
+private:
+    DifficultyCalculator calculator_;
+    float rate_;
+    bool loaded_ = false;
+
+    int keyCount_ = 0;
+    std::vector<TimingPoint> timingPoints_;
+    DifficultyCalculator::PreparedNotes prepared_;
+    std::vector<CalculatedNote> notes_;
+    DifficultyCalculator::NoteLists lists_;
+    DifficultyCalculator::WindowSkills windows_;
+    FinalResult result_{};
+
+    bool sameTiming(const ChartData& chart) const;
+    const FinalResult& refresh(const ChartData& chart, size_t firstWindow, size_t lastWindow);
+};
+
+#endif
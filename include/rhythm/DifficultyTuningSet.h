@@ -0,0 +1,45 @@
+#ifndef DIFFICULTY_TUNING_SET_H
+#define DIFFICULTY_TUNING_SET_H
+
+#include <rhythm/DifficultyCalculator.h>
+#include <vector>
+
+// Charts with target ratings, for scoring many DifficultyConfigs against the
+// same reference set. Note features don't depend on the config, so each
+// sample extracts them once in prepare(). Window skills are kept too and
+// reused while only the rating weights and P_NORM_EXPONENT change, which
+// leaves just the aggregation to redo per config.
+//
+// Samples are independent: different indices may be prepared and rated on
+// different threads at once, but one index only from one thread at a time.
+class DifficultyTuningSet {
+public:
+    explicit DifficultyTuningSet(DifficultyKernels kernels = DifficultyKernels::REFERENCE);
+
+    // Charts without notes have no rating to fit and are skipped.
+    bool add(const ChartData& chart, float rate, double target);
+
+    size_t size() const { return samples_.size(); }
+    const ChartData& getChart(size_t index) const { return samples_[index].chart; }
+    float getRate(size_t index) const { return samples_[index].rate; }
+    double getTarget(size_t index) const { return samples_[index].target; }
+
+    void prepare(size_t index);
+    double rate(size_t index, const DifficultyConfig& config);
+
+private:
+    struct Sample {
+        ChartData chart;
+        float rate;
+        double target;
+        std::vector<CalculatedNote> features;
+        bool hasWindows = false;
+        DifficultyConfig windowConfig;
+        DifficultyCalculator::WindowSkills windows;
+    };
+
+    DifficultyKernels kernels_;
+    std::vector<Sample> samples_;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef DIFFICULTY_WORKER_H
+#define DIFFICULTY_WORKER_H
+
+#include <rhythm/DifficultyCalculator.h>
+#include <rhythm/DifficultyDatabase.h>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Rates charts on a background thread and stores every result in a
+// DifficultyDatabase. Requests for the chart on screen go ahead of
+// speculative ones, and asking again for a chart and rate list that is
+// already queued or running shares the existing future.
+class DifficultyWorker {
+public:
+    using Results = std::shared_future<std::vector<FinalResult>>;
+
+    DifficultyWorker() = default;
+    ~DifficultyWorker();
+
+    DifficultyWorker(const DifficultyWorker&) = delete;
+    DifficultyWorker& operator=(const DifficultyWorker&) = delete;
+
+    void start(DifficultyDatabase& database, const DifficultyCalculator& calculator);
+    void stop();
+
+    // `chart` must stay alive until the future is ready or stop() returns.
+    Results submit(const ChartData& chart, std::vector<float> rates, bool speculative = false);
+
+    // Drops everything still queued; those futures resolve to an empty list.
+    // Work already running finishes and is stored.
+    void cancelQueued();
+
+private:
+    struct Job {
+        const ChartData* chart;
+        std::vector<float> rates;
+        bool speculative;
+        std::promise<std::vector<FinalResult>> promise;
+        Results future;
+    };
+
+    DifficultyDatabase* database_ = nullptr;
+    DifficultyCalculator calculator_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::shared_ptr<Job>> queue_;
+    std::shared_ptr<Job> current_;
+    std::thread thread_;
+    bool running_ = false;
+
+    void run();
+    void process(Job& job);
+};
+
+#endif
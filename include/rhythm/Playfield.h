@@ -7,6 +7,7 @@
 #include <objects/rhythm/HoldNote.h>
 #include <system/Logger.h>
 #include <utils/rhythm/ChartUtils.h>
+#include <utils/rhythm/ScrollVelocityMap.h>
 #include <rhythm/Conductor.h>
 #include <utils/rhythm/SkinUtils.h>
 #include <rhythm/JudgementSystem.h>
@@ -66,7 +67,7 @@ public:
         return playfieldWidth_;
     }
 
-    void loadNotes(ChartData* chartData);
+    void loadNotes(const ChartData* chartData);
     void setConductor(Conductor* conductor);
     Conductor* getConductor() const {
         return conductor_;
@@ -81,6 +82,8 @@ public:
         return keybinds_[index];
     }
 
+    float getVisualPosition() const { return visualPosition_; }
+
     float getStrumLinePos() const { return strumLinePos_; }
     float getStrumLineOffset() const { return strumLineOffset_;}
     float getJudgementOffset() const { return judgementOffset_; }
@@ -134,6 +137,10 @@ private:
     float paddingLeft_ = 16.0f;
     float paddingRight_ = 16.0f;
     
+    ScrollVelocityMap scrollVelocityMap_;
+    size_t scrollVelocityCursor_ = 0;
+    float visualPosition_ = 0.0f;
+
     std::vector<Strum*> strums_;
     std::vector<Note*> notes_;
     
@@ -3,9 +3,14 @@
 
 #include <BaseState.h>
 #include <utils/rhythm/ChartUtils.h>
+#include <utils/rhythm/SongLibrary.h>
+#include <utils/rhythm/SongSearchIndex.h>
 #include <rhythm/Conductor.h>
 #include <rhythm/DifficultyCalculator.h>
+#include <rhythm/DifficultyDatabase.h>
+#include <rhythm/DifficultyWorker.h>
 #include <objects/TextObject.h>
+#include <objects/StrainGraph.h>
 #include <SDL3/SDL.h>
 #include <SDL3_image/SDL_image.h>
 #include <vector>
@@ -13,19 +18,6 @@
 #include <map>
 #include <memory>
 
-struct SongEntry {
-    std::string title;
-    std::string artist;
-    std::string folderPath;
-    std::map<std::string, ChartData> difficulties;
-};
-
-struct SongPack {
-    std::string name;
-    std::vector<SongEntry> songs;
-    bool isExpanded = false;
-};
-
 struct FlatSongEntry {
     bool isPackHeader;
     int packIndex;
@@ -50,6 +42,13 @@ private:
 
     std::vector<SongPack> songPacks_;
     std::vector<FlatSongEntry> flatSongList_;
+    bool osuPackAdded_ = false;
+
+    SongSearchIndex searchIndex_;
+    std::string searchText_;
+    bool searchActive_ = false;
+    std::vector<SongSearchMatch> searchMatches_;
+    TextObject* searchTextObject_ = nullptr;
 
     SDL_Texture* currentBackgroundTexture_ = nullptr;
     SDL_Texture* nextBackgroundTexture_ = nullptr;
@@ -69,9 +68,24 @@ private:
     TextObject* diffTextObject_ = nullptr;
     TextObject* chartInfoText_ = nullptr;
     std::vector<TextObject*> chartTitles_;
+    StrainGraph* strainGraph_ = nullptr;
+
+    const float RATE_STEP = 0.1f;
+    const float RATE_LADDER_MIN = 0.5f;
+    const float RATE_LADDER_MAX = 2.0f;
+
+    const std::string DIFFICULTY_DB_PATH = "cache/difficulty.db";
+
+    const int NEIGHBOUR_PRERATE_RANGE = 2;
+
+    const float STRAIN_GRAPH_WIDTH = 360.0f;
+    const float STRAIN_GRAPH_HEIGHT = 72.0f;
 
     DifficultyCalculator calculator;
-    std::map<std::string, FinalResult> difficultyCache_;
+    DifficultyDatabase difficultyDb_;
+    DifficultyWorker difficultyWorker_;
+    DifficultyWorker::Results pendingDifficulty_;
+    uint64_t pendingDifficultyHash_ = 0;
     
     float listCenterX_ = 0.0f;
     float listCenterY_ = 0.0f;
@@ -84,12 +98,19 @@ private:
     ChartData& getCurrentSelectedChart();
     const ChartData& getCurrentSelectedChart() const;
     
-    SongEntry loadSongEntry(const std::string& songDirectory, const std::vector<std::string>& chartFiles);
     void loadAndCrossfadeBackground(const ChartData& chartData);
     
+    bool addOsuPack();
+    bool loadChart(ChartData& chart);
     void buildFlatSongList();
+    void applySearch();
+    bool handleSearchInput(const SDL_Event& event);
     void updateChartPositions();
     void updateDifficultyDisplay(ChartData& chartData);
+    void checkPendingDifficulty();
+    void showDifficulty(const FinalResult& result);
+    void prerateNeighbours();
+    std::vector<float> getDifficultyRates() const;
     void playChartPreview(const ChartData& chartData);
     void updateSelectedChartInfo(bool playPreview = true);
     void updateChartTitleList();
@@ -39,6 +39,7 @@ class ConductorInfo;
 class BaseState;
 class Conductor;
 class SettingsManager;
+class OsuUtils;
 
 using StateSwitcher = void (*)(AppContext*, int, void*);
 
@@ -86,6 +87,7 @@ struct AppContext
 
     Conductor* conductor = nullptr;
     SettingsManager* settingsManager = nullptr;
+    OsuUtils* osuUtils = nullptr;
     
     StateSwitcher switchState = nullptr;
     BaseState *currentState = nullptr;
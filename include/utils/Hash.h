@@ -0,0 +1,36 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <span>
+
+namespace Hash {
+    // Streaming XXH64. Output matches the reference implementation, so hashes
+    // are stable across builds and platforms and safe to persist.
+    class Xxh64 {
+    public:
+        explicit Xxh64(uint64_t seed = 0);
+
+        void update(const void* data, size_t length);
+        template <typename T>
+        void update(std::span<const T> values) { update(values.data(), values.size_bytes()); }
+        template <typename T>
+        void updateValue(const T& value) { update(&value, sizeof(T)); }
+
+        uint64_t digest() const;
+
+    private:
+        uint64_t acc_[4];
+        uint8_t buffer_[32];
+        size_t bufferSize_ = 0;
+        uint64_t totalLength_ = 0;
+        uint64_t seed_;
+    };
+
+    uint64_t xxh64(const void* data, size_t length, uint64_t seed = 0);
+    std::string toHex(uint64_t hash);
+}
+
+#endif
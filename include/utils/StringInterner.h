@@ -0,0 +1,54 @@
+#ifndef STRING_INTERNER_H
+#define STRING_INTERNER_H
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <mutex>
+
+// Library-wide pool of immutable strings. Every distinct value is stored once
+// and handed out by address, which stays valid for the lifetime of the program.
+class StringInterner {
+public:
+    static StringInterner& getInstance();
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    const std::string* intern(std::string_view value);
+    size_t size() const;
+
+    static const std::string* emptyString();
+
+private:
+    StringInterner() = default;
+
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_set<std::string, Hash, std::equal_to<>> strings_;
+};
+
+class InternedString {
+public:
+    InternedString() : value_(StringInterner::emptyString()) {}
+    InternedString(std::string_view value)
+        : value_(value.empty() ? StringInterner::emptyString() : StringInterner::getInstance().intern(value)) {}
+    InternedString(const std::string& value) : InternedString(std::string_view(value)) {}
+    InternedString(const char* value) : InternedString(std::string_view(value)) {}
+
+    const std::string& str() const { return *value_; }
+    operator const std::string&() const { return *value_; }
+    bool empty() const { return value_->empty(); }
+
+    bool operator==(const InternedString& other) const { return value_ == other.value_; }
+    bool operator!=(const InternedString& other) const { return value_ != other.value_; }
+
+private:
+    const std::string* value_;
+};
+
+#endif
@@ -21,7 +21,7 @@ namespace Utils {
     std::string formatMemorySize(size_t bytes);
     std::string toString(int value);
 
-    std::vector<std::string> getChartList(); 
+    std::vector<std::string> getChartList(const std::string& directoryPath = "assets/songs/");
     std::vector<std::string> getChartFiles(const std::string& chartDirectory);
     static bool fileExists(const std::string& path);
     std::string getChartAssetPath(const ChartData &chartData, const std::string &assetName);
@@ -4,34 +4,102 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <cstdint>
 #include <algorithm>
 #include <system/Logger.h>
+#include <utils/StringInterner.h>
+#include <utils/rhythm/NoteData.h>
 
-enum NoteType { TAP, HOLD_START, HOLD_END, MINE };
-
-struct NoteStruct {
+struct TimingPoint {
     float time;
-    int column;
-    NoteType type;
-    
-    bool operator<(const NoteStruct& other) const {
-        return time < other.time;
-    }
+    double bpm;
 };
 
-struct TimingPoint {
+struct ScrollVelocity {
     float time;
-    double bpm;
+    double multiplier;
+};
+
+struct TimingSegment {
+    double beat;
+    double value;
+};
+
+// Beat-based timing as StepMania stores it. Values are BPM for bpms, seconds
+// for stops and delays, and length in beats for warps.
+struct TimingData {
+    double offset = 0.0;
+    std::vector<TimingSegment> bpms;
+    std::vector<TimingSegment> stops;
+    std::vector<TimingSegment> delays;
+    std::vector<TimingSegment> warps;
+
+    bool empty() const { return bpms.empty(); }
+    static TimingData fromTimingPoints(const std::vector<TimingPoint>& timingPoints);
+};
+
+// Well-known chart fields. Strings are interned because every difficulty of a
+// song repeats the same title, artist and file names; unknown keys go to `extra`.
+struct ChartMetadata {
+    InternedString title;
+    InternedString artist;
+    InternedString charter;
+    InternedString difficulty;
+    InternedString audio;
+    InternedString background;
+    InternedString mode;
+    float previewTime = -1.0f;
+    float previewLength = -1.0f;
+
+    std::map<std::string, std::string> extra;
+
+    void set(const std::string& key, const std::string& value);
+    void fillMissing(const ChartMetadata& other);
+    std::vector<std::pair<std::string, std::string>> entries() const;
+};
+
+// What ChartValidator changed while normalizing a chart on import.
+struct ChartValidationReport {
+    int invalidTimes = 0;
+    int outOfRangeColumns = 0;
+    int duplicateNotes = 0;
+    int tapsOnHoldStarts = 0;
+    int notesInsideHolds = 0;
+    int orphanedHoldEnds = 0;
+    int unterminatedHolds = 0;
+    int zeroLengthHolds = 0;
+
+    int total() const;
+    bool empty() const { return total() == 0; }
+    void merge(const ChartValidationReport& other);
+    // e.g. "3 orphaned hold ends, 1 note inside a hold"; empty if nothing changed.
+    std::string summary() const;
 };
 
 struct ChartData {
     std::string filename;
     std::string filePath;
 
-    std::vector<NoteStruct> notes;
+    std::shared_ptr<const NoteData> notes = std::make_shared<const NoteData>();
     std::vector<TimingPoint> timingPoints;
-    std::map<std::string, std::string> metadata;
+    TimingData timing;
+    std::vector<ScrollVelocity> scrollVelocities;
+    ChartMetadata metadata;
     int keyCount = 4;
+
+    // XXH64 of the playable content (key count, notes, timing). Identical
+    // charts hash the same wherever they live on disk.
+    uint64_t hash = 0;
+    ChartValidationReport validation;
+
+    // Listed from osu!.db without reading the chart file: metadata, key count
+    // and timing are set but notes and hash are not until
+    // SongLibrary::loadChart() parses it.
+    bool deferred = false;
+    // Length osu!.db lists for a deferred chart, which has no notes to
+    // measure yet.
+    float deferredLengthMs = 0.0f;
 };
 
 class ChartUtils {
@@ -42,6 +110,10 @@ public:
     static ChartData parseChart(const std::string& filePath, const std::string& filename, const std::string& content);
     static std::map<std::string, ChartData> parseChartMultiple(const std::string& filePath, const std::string& filename, const std::string& content);
     static std::string saveVsc(const std::string& filename, const ChartData& chartData);
+    static std::string serializeVsc(const ChartData& chartData);
+    // Appends to `out`, so a caller converting many charts can reuse one buffer.
+    static void serializeVsc(const ChartData& chartData, std::string& out);
+    static uint64_t computeChartHash(const ChartData& chartData);
     
 private:
     static ChartData parseVsc(const std::string& content);
@@ -0,0 +1,25 @@
+#ifndef CHART_VALIDATOR_H
+#define CHART_VALIDATOR_H
+
+#include <utils/rhythm/ChartUtils.h>
+
+// Normalizes imported note data in one pass so gameplay never sees broken
+// charts. Afterwards every note has a finite time and an in-range column,
+// holds never overlap anything in their column, and every HOLD_START is
+// paired with a later HOLD_END. Repairs:
+//   - non-finite times, out-of-range columns and exact duplicates (same
+//     time, column and type) are dropped
+//   - a tap sharing its time and column with a hold start is dropped
+//   - taps, mines and hold starts inside a running hold are dropped
+//   - HOLD_ENDs with no open hold are dropped
+//   - holds with no end, or ending at their start, become taps; a stray
+//     HOLD_END on a hold's start is dropped and leaves the hold alone
+class ChartValidator {
+public:
+    // Packs `notes` into chart.notes and repairs them; chart.keyCount must
+    // already be set. Columns are range-checked here, before NoteData stores
+    // them as uint8_t, so a corrupt one can't wrap onto a real lane.
+    static ChartValidationReport validate(ChartData& chart, std::vector<NoteStruct> notes);
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef NOTE_DATA_H
+#define NOTE_DATA_H
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+enum NoteType { TAP, HOLD_START, HOLD_END, MINE };
+
+struct NoteStruct {
+    float time;
+    int column;
+    NoteType type;
+    
+    bool operator<(const NoteStruct& other) const {
+        return time < other.time;
+    }
+};
+
+// Immutable structure-of-arrays note storage. Notes are sorted by time on
+// construction and every hold start/end knows the index of its partner, so
+// consumers never have to re-pair holds. Charts share one instance through
+// shared_ptr<const NoteData>.
+class NoteData {
+public:
+    NoteData() = default;
+    explicit NoteData(std::vector<NoteStruct> notes);
+
+    size_t size() const { return times_.size(); }
+    bool empty() const { return times_.empty(); }
+
+    std::span<const float> times() const { return times_; }
+    std::span<const uint8_t> columns() const { return columns_; }
+    std::span<const uint8_t> types() const { return types_; }
+    std::span<const int32_t> pairedIndices() const { return pairedIndices_; }
+
+    float getTime(size_t index) const { return times_[index]; }
+    int getColumn(size_t index) const { return columns_[index]; }
+    NoteType getType(size_t index) const { return static_cast<NoteType>(types_[index]); }
+    // Index of the other end of a hold, or -1 for taps, mines and unpaired ends.
+    int getPairedIndex(size_t index) const { return pairedIndices_[index]; }
+
+    NoteStruct at(size_t index) const {
+        return {times_[index], getColumn(index), getType(index)};
+    }
+    std::vector<NoteStruct> toNoteStructs() const;
+
+private:
+    std::vector<float> times_;
+    std::vector<uint8_t> columns_;
+    std::vector<uint8_t> types_;
+    std::vector<int32_t> pairedIndices_;
+};
+
+#endif
@@ -3,6 +3,34 @@
 
 #include <string>
 #include <thread>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <utils/rhythm/ChartUtils.h>
+
+struct OsuBeatmapEntry {
+    std::string artist;
+    std::string title;
+    std::string creator;
+    std::string difficulty;
+    std::string audioFile;
+    std::string md5;
+    std::string osuFile;
+    std::string folderName;
+
+    int keyCount = 4;
+    float hpDrain = 0.0f;
+    float overallDifficulty = 0.0f;
+    double starRating = 0.0;
+
+    int totalTime = 0;
+    int previewTime = -1;
+    int beatmapId = 0;
+    int beatmapSetId = 0;
+
+    std::vector<TimingPoint> timingPoints;
+    std::vector<ScrollVelocity> scrollVelocities;
+};
 
 class OsuUtils {
 public:
@@ -15,24 +43,32 @@ public:
 
     std::string getOsuDatabasePath();
     void parseOsuDatabase();
+    // Where the beatmap folders named in the database live; set once
+    // parseOsuDatabase() has started.
+    const std::string& getSongsDirectory() const { return songsDirectory_; }
+
+    // Reads every osu!mania beatmap record from an osu!.db file. Throws on a
+    // missing or truncated database.
+    static std::vector<OsuBeatmapEntry> readDatabase(const std::string& path);
 
     bool isParsingActive() const {
-        return parserThread_.joinable();
+        return parserThread_.joinable() && !parsingFinished_.load();
+    }
+    bool isParsingFinished() const { return parsingFinished_.load(); }
+
+    std::vector<OsuBeatmapEntry> getBeatmaps() const {
+        std::lock_guard<std::mutex> lock(beatmapsMutex_);
+        return beatmaps_;
     }
 private:
     std::thread parserThread_;
+    std::atomic<bool> parsingFinished_{false};
+    std::string songsDirectory_;
 
-    void parseDatabaseThread(const std::string& path) {
-        try {
-            GAME_LOG_INFO("OsuUtils: Starting osu! database parsing thread.");
-            // TODO: Parse the database
-            GAME_LOG_INFO("OsuUtils: Finished osu! database parsing.");
-        } catch (const std::exception& e) {
-            GAME_LOG_ERROR(std::string("OsuUtils: Error parsing osu! database: ") + e.what());
-        } catch (...) {
-            GAME_LOG_ERROR("OsuUtils: Unknown error occurred while parsing osu! database.");
-        }
-    }
+    mutable std::mutex beatmapsMutex_;
+    std::vector<OsuBeatmapEntry> beatmaps_;
+
+    void parseDatabaseThread(const std::string& path);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,37 @@
+#ifndef SCROLL_VELOCITY_MAP_H
+#define SCROLL_VELOCITY_MAP_H
+
+#include <vector>
+#include <utils/rhythm/ChartUtils.h>
+
+// Cumulative scroll position for a chart's SV changes. Positions are in
+// "visual milliseconds": without SV a note's position equals its time, so
+// the scroll distance between two objects is just the difference of their
+// positions.
+class ScrollVelocityMap {
+public:
+    ScrollVelocityMap() = default;
+    explicit ScrollVelocityMap(const std::vector<ScrollVelocity>& scrollVelocities);
+
+    double getPositionAt(double timeMs) const;
+    // Same as above, but walks from `cursor` instead of searching. Intended for
+    // queries that move forward in time (per-frame updates, sorted notes).
+    double getPositionAt(double timeMs, size_t& cursor) const;
+    double getMultiplierAt(double timeMs) const;
+
+    bool empty() const { return segments_.empty(); }
+
+private:
+    struct Segment {
+        double time;
+        double position;
+        double multiplier;
+    };
+
+    std::vector<Segment> segments_;
+
+    size_t findSegment(double timeMs) const;
+    double positionInSegment(size_t index, double timeMs) const;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef SONG_LIBRARY_H
+#define SONG_LIBRARY_H
+
+#include <utils/rhythm/ChartUtils.h>
+#include <string>
+#include <vector>
+#include <map>
+
+struct SongEntry {
+    std::string title;
+    std::string artist;
+    std::string folderPath;
+    std::map<std::string, ChartData> difficulties;
+};
+
+struct OsuBeatmapEntry;
+
+struct SongPack {
+    std::string name;
+    std::vector<SongEntry> songs;
+    bool isExpanded = false;
+};
+
+class SongLibrary {
+public:
+    // Folders directly under the songs directory that contain charts go into a
+    // "Miscellaneous" pack; any other folder is a pack of song folders.
+    static std::vector<SongPack> build(const std::string& songsDirectory = "assets/songs/");
+    static SongEntry loadSongEntry(const std::string& songDirectory, const std::vector<std::string>& chartFiles);
+
+    // An "osu!" pack of osu!.db records, one song per beatmap folder under
+    // `songsDirectory`. Every chart starts out deferred.
+    static SongPack buildOsuPack(const std::vector<OsuBeatmapEntry>& beatmaps, const std::string& songsDirectory);
+    // Parses a deferred chart in place and leaves any other chart alone.
+    // Returns false, with the chart still deferred, if the file couldn't be
+    // read or has no notes.
+    static bool loadChart(ChartData& chart);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef SONG_SEARCH_INDEX_H
+#define SONG_SEARCH_INDEX_H
+
+#include <utils/rhythm/SongLibrary.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Zero (or a non-positive max) means the bound is off. BPM and length are
+// compared after applying `rate`.
+struct SongSearchFilter {
+    float rate = 1.0f;
+    int keyCount = 0;
+    double minDifficulty = 0.0;
+    double maxDifficulty = 0.0;
+    double minBpm = 0.0;
+    double maxBpm = 0.0;
+    float minLength = 0.0f;
+    float maxLength = 0.0f;
+
+    bool hasDifficulty() const { return minDifficulty > 0.0 || maxDifficulty > 0.0; }
+};
+
+struct SongSearchQuery {
+    std::vector<std::string> terms;
+    SongSearchFilter filter;
+
+    bool empty() const;
+};
+
+struct SongSearchMatch {
+    int packIndex;
+    int songIndex;
+};
+
+// N-gram index over the title, artist, charter and pack name of every chart in
+// the library. Terms match as case-insensitive substrings: terms of three or
+// more characters intersect trigram postings, shorter ones use exact 1/2-gram
+// postings. Results come back in library order, one entry per song.
+class SongSearchIndex {
+public:
+    // Rate-adjusted difficulty of a chart, or a negative value when it is not
+    // known yet. Unknown charts are never dropped by a difficulty filter.
+    using DifficultyLookup = std::function<double(const ChartData& chart, float rate)>;
+
+    // Holds pointers into `packs`; rebuild after the library changes.
+    void build(const std::vector<SongPack>& packs);
+    void clear();
+    // Re-reads the key count, BPM and length of an indexed chart, e.g. once a
+    // deferred chart has loaded. Text is left alone.
+    void updateChart(const ChartData& chart);
+
+    // Free text plus inline filters, e.g. "camellia keys=7 bpm>180 len<120 diff>=25".
+    // Filter keys are keys, bpm, len/length (seconds) and diff/msd; operators
+    // are =, <, >, <= and >=.
+    static SongSearchQuery parseQuery(const std::string& text, float rate);
+
+    std::vector<SongSearchMatch> search(const SongSearchQuery& query, const DifficultyLookup& difficultyLookup = nullptr);
+
+    size_t getChartCount() const { return charts_.size(); }
+
+private:
+    struct IndexedChart {
+        int packIndex;
+        int songIndex;
+        const ChartData* chart;
+        std::string text;
+        int keyCount;
+        double bpm;
+        float lengthSeconds;
+    };
+
+    std::vector<IndexedChart> charts_;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings_;
+
+    // Text matches of the previous query, before filters. While the user keeps
+    // typing, the new terms only extend the old ones, so these are a superset
+    // of the new matches and get narrowed when that is cheaper than
+    // intersecting postings again.
+    std::vector<std::string> lastTerms_;
+    std::vector<uint32_t> lastTextMatches_;
+    bool hasLastQuery_ = false;
+
+    const std::vector<uint32_t>& matchTerms(const std::vector<std::string>& terms);
+    bool passesFilter(const IndexedChart& chart, const SongSearchFilter& filter, const DifficultyLookup& difficultyLookup) const;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef TIMING_MAP_H
+#define TIMING_MAP_H
+
+#include <vector>
+#include <utils/rhythm/ChartUtils.h>
+
+// Beat <-> time lookup table for beat-based timing (StepMania #BPMS, #STOPS,
+// #DELAYS and #WARPS). Built once per chart; every query is a binary search
+// over cumulative segment start times instead of a walk over the timing data.
+class TimingMap {
+public:
+    static constexpr double DEFAULT_BPM = 120.0;
+
+    TimingMap() = default;
+    explicit TimingMap(const TimingData& timing);
+    TimingMap(const std::vector<TimingPoint>& bpmChanges, double offset);
+
+    double getSecondsAtBeat(double beat) const;
+    double getBeatAtSeconds(double seconds) const;
+    double getBpmAtBeat(double beat) const;
+    double getBpmAtSeconds(double seconds) const;
+    int getBpmIndexAtSeconds(double seconds) const;
+
+    bool isBeatWarped(double beat) const;
+    std::vector<TimingPoint> toTimingPoints() const;
+
+    bool empty() const { return segments_.empty(); }
+    size_t getSegmentCount() const { return segments_.size(); }
+
+private:
+    // One entry per beat where anything changes. The chart reaches `beat` at
+    // `arriveSeconds`, notes on it are hit at `noteSeconds` (after delays) and
+    // scrolling resumes at `moveSeconds` (after stops).
+    struct Segment {
+        double beat;
+        double arriveSeconds;
+        double noteSeconds;
+        double moveSeconds;
+        double bpm;
+        double warpEnd;
+        int bpmIndex;
+    };
+
+    struct WarpRange {
+        double start;
+        double end;
+    };
+
+    std::vector<Segment> segments_;
+    std::vector<WarpRange> warps_;
+
+    void build(const TimingData& timing);
+    size_t findSegmentByBeat(double beat) const;
+    size_t findSegmentBySeconds(double seconds) const;
+};
+
+#endif
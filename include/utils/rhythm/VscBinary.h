@@ -0,0 +1,23 @@
+#ifndef VSC_BINARY_H
+#define VSC_BINARY_H
+
+#include <utils/rhythm/ChartUtils.h>
+#include <string>
+#include <string_view>
+
+// Binary VSC v2 (.vscb). Holds the same content as a text .vsc. Note times
+// are stored as varint deltas of their float bit patterns, so they round-trip
+// exactly, and each column/type pair is bit-packed at the width the key count
+// needs. All multi-byte values are little-endian.
+class VscBinary {
+public:
+    static constexpr uint16_t VERSION = 2;
+
+    static bool isBinary(std::string_view content);
+    static std::string serialize(const ChartData& chartData);
+    static void serialize(const ChartData& chartData, std::string& out);
+    // Logs and returns an empty chart if the data is truncated or malformed.
+    static ChartData parse(std::string_view content);
+};
+
+#endif
@@ -167,6 +167,7 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[])
 
     OsuUtils* osuUtils = new OsuUtils();
     osuUtils->parseOsuDatabase();
+    app->osuUtils = osuUtils;
 
     if (!app->renderer)
     {
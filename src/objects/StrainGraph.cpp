@@ -0,0 +1,68 @@
+#include "objects/StrainGraph.h"
+
+static constexpr SDL_FColor BACKGROUND_COLOR = {0.0f, 0.0f, 0.0f, 0.5f};
+static constexpr SDL_FColor RICE_COLOR = {0.35f, 0.75f, 1.0f, 0.75f};
+static constexpr SDL_FColor LN_COLOR = {1.0f, 0.55f, 0.25f, 0.6f};
+
+StrainGraph::StrainGraph(SDL_Renderer* renderer) : renderer_(renderer) {}
+
+void StrainGraph::setRect(const SDL_FRect& rect)
+{
+    rect_ = rect;
+    rebuild();
+}
+
+void StrainGraph::setCurve(const StrainCurve& curve)
+{
+    curve_ = curve;
+    rebuild();
+}
+
+void StrainGraph::clear()
+{
+    curve_ = StrainCurve();
+    vertices_.clear();
+}
+
+void StrainGraph::render()
+{
+    if (!renderer_ || vertices_.empty()) return;
+    SDL_RenderGeometry(renderer_, nullptr, vertices_.data(), static_cast<int>(vertices_.size()), nullptr, 0);
+}
+
+// Trapezoid from (x0, y0Top) to (x1, y1Top) down to `bottom`, as two triangles.
+void StrainGraph::addQuad(float x0, float y0Top, float x1, float y1Top, float bottom, SDL_FColor color)
+{
+    const SDL_FPoint noTexture = {0.0f, 0.0f};
+    SDL_Vertex topLeft = {{x0, y0Top}, color, noTexture};
+    SDL_Vertex topRight = {{x1, y1Top}, color, noTexture};
+    SDL_Vertex bottomLeft = {{x0, bottom}, color, noTexture};
+    SDL_Vertex bottomRight = {{x1, bottom}, color, noTexture};
+
+    vertices_.insert(vertices_.end(), {topLeft, topRight, bottomLeft, topRight, bottomRight, bottomLeft});
+}
+
+void StrainGraph::rebuild()
+{
+    vertices_.clear();
+    if (curve_.size() < 2 || rect_.w <= 0.0f || rect_.h <= 0.0f) return;
+
+    const float bottom = rect_.y + rect_.h;
+    const float step = rect_.w / static_cast<float>(curve_.size() - 1);
+    vertices_.reserve(6 + 12 * (curve_.size() - 1));
+
+    addQuad(rect_.x, rect_.y, rect_.x + rect_.w, rect_.y, bottom, BACKGROUND_COLOR);
+
+    // Samples are already fractions of the curve's peak, which fills the rect.
+    auto sampleY = [&](uint8_t sample) { return bottom - sample / 255.0f * rect_.h; };
+    for (size_t i = 0; i + 1 < curve_.size(); ++i) {
+        float x0 = rect_.x + step * i;
+        float x1 = x0 + step;
+        addQuad(x0, sampleY(curve_.rice[i]), x1, sampleY(curve_.rice[i + 1]), bottom, RICE_COLOR);
+    }
+    for (size_t i = 0; i + 1 < curve_.size(); ++i) {
+        float x0 = rect_.x + step * i;
+        float x1 = x0 + step;
+        addQuad(x0, sampleY(curve_.ln[i]), x1, sampleY(curve_.ln[i + 1]), bottom, LN_COLOR);
+    }
+}
@@ -133,8 +133,7 @@ void HoldNote::update(float deltaTime)
         return;
 
     float currentTime = conductor->getSongPosition();
-    float endNoteTime = getEndTime() / 1000.0f;
-    float timeDiff = endNoteTime - currentTime;
+    float timeDiff = (getEndVisualTime() - playfield->getVisualPosition()) / 1000.0f;
 
     float playbackRateCompensation = (currentTime < 0.0f) ? 1.0f : conductor->getPlaybackRate();
 
@@ -102,8 +102,7 @@ void Note::update(float deltaTime) {
     if (!getUpdatePos()) return;
 
     float currentTime = conductor->getSongPosition();
-    float noteTime = getTime() / 1000.0f;
-    float timeDiff = noteTime - currentTime;
+    float timeDiff = (getVisualTime() - playfield->getVisualPosition()) / 1000.0f;
 
     float playbackRateCompensation = (currentTime < 0.0f) ? 1.0f : conductor->getPlaybackRate();
 
@@ -18,26 +18,21 @@ float Conductor::getSongDuration() const
     return AudioManager::getInstance().getMusicDuration();
 }
 
-bool Conductor::initialize(const std::vector<TimingPoint> &timingPoints, const std::string &audioPath, float playbackRate, float crossfadeDuration, float startTime)
+bool Conductor::initialize(const TimingData &timing, const std::string &audioPath, float playbackRate, float crossfadeDuration, float startTime)
 {
-    if (timingPoints.empty())
+    if (timing.empty())
     {
         GAME_LOG_ERROR("Conductor: No timing points provided");
         return false;
     }
 
-    timingPoints_ = timingPoints;
-    std::sort(timingPoints_.begin(), timingPoints_.end(),
-              [](const TimingPoint &a, const TimingPoint &b)
-              {
-                  return a.time < b.time;
-              });
+    timingMap_ = TimingMap(timing);
 
     audioPath_ = audioPath;
     playbackRate_ = playbackRate;
     crossfadeDuration_ = crossfadeDuration;
 
-    currentBPM_ = timingPoints_[0].bpm;
+    currentBPM_ = timingMap_.getBpmAtBeat(0.0);
     crotchet_ = 60.0f / currentBPM_;
     currentTimingIndex_ = 0;
 
@@ -135,7 +130,7 @@ void Conductor::stop()
     songPosition_ = 0.0f;
     songPositionInBeats_ = 0.0f;
     currentTimingIndex_ = 0;
-    currentBPM_ = timingPoints_[0].bpm;
+    currentBPM_ = timingMap_.getBpmAtBeat(0.0);
     crotchet_ = 60.0f / currentBPM_;
 }
 
@@ -336,14 +331,12 @@ void Conductor::setPlaybackRate(float rate)
 
 void Conductor::updateBPM()
 {
-    int timeMs = static_cast<int>(songPosition_ * 1000.0f);
-
-    int newIndex = findTimingPointIndex(songPosition_);
+    int newIndex = timingMap_.getBpmIndexAtSeconds(songPosition_);
 
     if (newIndex != currentTimingIndex_)
     {
         currentTimingIndex_ = newIndex;
-        currentBPM_ = timingPoints_[currentTimingIndex_].bpm;
+        currentBPM_ = timingMap_.getBpmAtSeconds(songPosition_);
         crotchet_ = 60.0f / currentBPM_;
 
         if (onBPMChangeCallback_)
@@ -353,124 +346,26 @@ void Conductor::updateBPM()
     }
 }
 
-int Conductor::findTimingPointIndex(float timeInSeconds) const
-{
-    int timeMs = static_cast<int>(timeInSeconds * 1000.0f);
-
-    for (int i = static_cast<int>(timingPoints_.size()) - 1; i >= 0; --i)
-    {
-        if (timingPoints_[i].time <= timeMs)
-        {
-            return i;
-        }
-    }
-
-    return 0;
-}
-
-float Conductor::calculateBeats(float startTime, float endTime) const
-{
-    if (startTime >= endTime)
-        return 0.0f;
-
-    int startMs = static_cast<int>(startTime * 1000.0f);
-    int endMs = static_cast<int>(endTime * 1000.0f);
-
-    float totalBeats = 0.0f;
-
-    int startIndex = findTimingPointIndex(startTime);
-
-    for (size_t i = startIndex; i < timingPoints_.size(); ++i)
-    {
-        float sectionStartTime = std::max(startTime, timingPoints_[i].time / 1000.0f);
-
-        float sectionEndTime;
-        if (i + 1 < timingPoints_.size())
-        {
-            sectionEndTime = std::min(endTime, timingPoints_[i + 1].time / 1000.0f);
-        }
-        else
-        {
-            sectionEndTime = endTime;
-        }
-
-        if (sectionStartTime >= sectionEndTime)
-            break;
-
-        float sectionDuration = sectionEndTime - sectionStartTime;
-        float beatsPerSecond = timingPoints_[i].bpm / 60.0f;
-        totalBeats += sectionDuration * beatsPerSecond;
-
-        if (sectionEndTime >= endTime)
-            break;
-    }
-
-    return totalBeats;
-}
-
 float Conductor::getBeatsAtTime(float timeInSeconds) const
 {
-    if (timingPoints_.empty())
+    if (timingMap_.empty())
         return 0.0f;
 
-    float startTime = timingPoints_[0].time / 1000.0f;
-
-    if (timeInSeconds <= startTime)
-    {
-        float duration = timeInSeconds;
-        float beatsPerSecond = timingPoints_[0].bpm / 60.0f;
-        return duration * beatsPerSecond;
-    }
-
-    return calculateBeats(startTime, timeInSeconds);
+    return static_cast<float>(timingMap_.getBeatAtSeconds(timeInSeconds));
 }
 
 float Conductor::getBeatLength(float timePos) const
 {
-    int index = findTimingPointIndex(timePos);
-    if (index >= 0 && index < timingPoints_.size())
-    {
-        return 60.0f / timingPoints_[index].bpm;
-    }
-    return 0.5f;
+    if (timingMap_.empty())
+        return 0.5f;
+
+    return static_cast<float>(60.0 / timingMap_.getBpmAtSeconds(timePos));
 }
 
 float Conductor::getTimeAtBeat(float beat) const
 {
-    if (timingPoints_.empty() || beat <= 0.0f)
+    if (timingMap_.empty())
         return 0.0f;
 
-    float currentTime = timingPoints_[0].time / 1000.0f;
-    float currentBeat = 0.0f;
-
-    for (size_t i = 0; i < timingPoints_.size(); ++i)
-    {
-        float sectionStartTime = timingPoints_[i].time / 1000.0f;
-        float beatsPerSecond = timingPoints_[i].bpm / 60.0f;
-
-        float sectionEndTime;
-        if (i + 1 < timingPoints_.size())
-        {
-            sectionEndTime = timingPoints_[i + 1].time / 1000.0f;
-        }
-        else
-        {
-            float remainingBeats = beat - currentBeat;
-            return sectionStartTime + (remainingBeats / beatsPerSecond);
-        }
-
-        float sectionDuration = sectionEndTime - sectionStartTime;
-        float sectionBeats = sectionDuration * beatsPerSecond;
-
-        if (currentBeat + sectionBeats >= beat)
-        {
-            float beatsIntoSection = beat - currentBeat;
-            return sectionStartTime + (beatsIntoSection / beatsPerSecond);
-        }
-
-        currentBeat += sectionBeats;
-        currentTime = sectionEndTime;
-    }
-
-    return currentTime;
-}
\ No newline at end of file
+    return static_cast<float>(timingMap_.getSecondsAtBeat(beat));
+}
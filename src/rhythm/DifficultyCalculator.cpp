@@ -6,6 +6,119 @@
 #include <numeric>
 #include <limits>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <bit>
+#include <array>
+#include <map>
+#include <cstring>
+
+// log2 for x > 0: the exponent comes from the float bits and the mantissa,
+// folded into [sqrt(1/2), sqrt(2)), goes through five terms of the atanh
+// series. Truncation error is below 1e-9, under float rounding.
+static inline float fastLog2(float x) {
+    uint32_t bits = std::bit_cast<uint32_t>(x);
+    // Mantissas above sqrt(2) (bits 0x3504F3) are halved by giving them
+    // exponent -1 instead of 0.
+    uint32_t fold = (bits & 0x007FFFFFu) > 0x003504F3u ? 1u : 0u;
+    float exponent = static_cast<float>(static_cast<int>(((bits >> 23) & 0xFF) + fold) - 127);
+    float mantissa = std::bit_cast<float>((bits & 0x007FFFFFu) | (0x3F800000u - (fold << 23)));
+
+    float s = (mantissa - 1.0f) / (mantissa + 1.0f);
+    float s2 = s * s;
+    float series = s * (2.0f + s2 * (2.0f / 3.0f + s2 * (2.0f / 5.0f + s2 * (2.0f / 7.0f + s2 * (2.0f / 9.0f)))));
+    return exponent + series * 1.44269504f;
+}
+
+// 2^x for |x| < 126: the integer part goes straight into the exponent bits
+// and the remainder in [-0.5, 0.5] through a degree-7 Taylor series.
+static inline float fastExp2(float x) {
+    // Adding and removing 1.5 * 2^23 rounds to the nearest integer.
+    float whole = (x + 12582912.0f) - 12582912.0f;
+    float t = (x - whole) * 0.69314718f;
+    float series = 1.0f + t * (1.0f + t * (1.0f / 2.0f + t * (1.0f / 6.0f + t * (1.0f / 24.0f
+        + t * (1.0f / 120.0f + t * (1.0f / 720.0f + t * (1.0f / 5040.0f)))))));
+    uint32_t scale = static_cast<uint32_t>(static_cast<int>(whole) + 127) << 23;
+    return series * std::bit_cast<float>(scale);
+}
+
+// `value` when `condition` holds, else +0. Done on the bits: a float select
+// or multiply-by-mask gets turned back into a branch around the arithmetic,
+// which trapping math then refuses to vectorize.
+static inline float keep(bool condition, float value) {
+    return std::bit_cast<float>(std::bit_cast<uint32_t>(value) & (condition ? 0xFFFFFFFFu : 0u));
+}
+
+static inline float fastPow(float base, float exponent) {
+    return fastExp2(exponent * fastLog2(base));
+}
+
+// Per-column scratch storage and hand assignment for a key count fixed at
+// compile time: arrays instead of heap vectors, and the left hand as a
+// constant bit mask instead of comparing against keyCount / 2.0 per note.
+template <int Columns>
+struct KeyLayout {
+    template <typename T>
+    using PerColumn = std::array<T, Columns>;
+    template <typename T>
+    using PerColumnPair = std::array<T, Columns * Columns>;
+
+    // Columns below half the key count, so the middle column of an odd
+    // layout is the left hand's.
+    static constexpr uint32_t LEFT_HAND = (1u << ((Columns + 1) / 2)) - 1;
+
+    explicit KeyLayout(int) {}
+
+    static constexpr size_t columns() { return Columns; }
+    static bool isLeftHand(int column) { return (LEFT_HAND >> column) & 1u; }
+
+    template <typename T>
+    static PerColumn<T> perColumn(T value) {
+        PerColumn<T> values;
+        values.fill(value);
+        return values;
+    }
+
+    template <typename T>
+    static PerColumnPair<T> perColumnPair(T value) {
+        PerColumnPair<T> values;
+        values.fill(value);
+        return values;
+    }
+};
+
+// Any other key count, sized at run time.
+template <>
+struct KeyLayout<0> {
+    explicit KeyLayout(int keyCount) : keyCount(keyCount), halfKey(keyCount / 2.0) {}
+
+    size_t columns() const { return keyCount > 0 ? static_cast<size_t>(keyCount) : 0; }
+    bool isLeftHand(int column) const { return column < halfKey; }
+
+    template <typename T>
+    std::vector<T> perColumn(T value) const { return std::vector<T>(columns(), value); }
+
+    template <typename T>
+    std::vector<T> perColumnPair(T value) const { return std::vector<T>(columns() * columns(), value); }
+
+    int keyCount;
+    double halfKey;
+};
+
+template <typename Fn>
+static auto withKeyLayout(int keyCount, bool specialized, Fn&& fn) {
+    if (specialized) {
+        switch (keyCount) {
+            case 4: return fn(KeyLayout<4>(keyCount));
+            case 5: return fn(KeyLayout<5>(keyCount));
+            case 6: return fn(KeyLayout<6>(keyCount));
+            case 7: return fn(KeyLayout<7>(keyCount));
+            case 8: return fn(KeyLayout<8>(keyCount));
+            default: break;
+        }
+    }
+    return fn(KeyLayout<0>(keyCount));
+}
 
 DifficultyCalculator::DifficultyCalculator(DifficultyConfig cfg) : config(cfg) {}
 
@@ -13,52 +126,209 @@ void DifficultyCalculator::setConfig(const DifficultyConfig& cfg) {
     config = cfg;
 }
 
-void DifficultyCalculator::extractFeatures(ChartData& chartData, float rate) {
-    processedNotes.clear();
-    for (const auto& n : chartData.notes) {
-        if (n.type == MINE) continue;
+void DifficultyCalculator::setKernels(DifficultyKernels mode) {
+    kernels = mode;
+}
+
+void DifficultyCalculator::setSpecializedKeyLayouts(bool enabled) {
+    specializedKeyLayouts = enabled;
+}
+
+void DifficultyCalculator::setStrainCurves(bool enabled) {
+    strainCurves = enabled;
+}
+
+void DifficultyCalculator::setPairwiseLnShields(bool enabled) {
+    pairwiseLnShields = enabled;
+}
 
-        int adjustedTime = static_cast<int>(n.time / rate);
-        processedNotes.push_back({adjustedTime, n.column, n.type});
+// Per-note terms of the five rice kernels, the same expressions as the
+// reference loops but over contiguous columns with selects instead of
+// branches so the loop vectorizes. Stored as prefix sums so a window total
+// is one subtraction.
+DifficultyCalculator::RiceTermSums DifficultyCalculator::computeRiceTermSums(const std::vector<const CalculatedNote*>& rice) const {
+    RiceTermSums sums;
+    for (RiceKernelTerms* kernel : {&sums.stream, &sums.jumpstream, &sums.handstream, &sums.jack, &sums.chordjack}) {
+        kernel->terms.resize(rice.size());
     }
+    fillRiceTerms(rice, 0, rice.size(), sums);
+    accumulateRiceTerms(sums, 0);
+    return sums;
+}
 
-    int keyCount = chartData.keyCount;
-    if (processedNotes.empty()) return;
+// Writes the terms of rice[begin, end) into `sums`, whose term arrays must
+// already cover that range. Each term only depends on its own note.
+void DifficultyCalculator::fillRiceTerms(const std::vector<const CalculatedNote*>& rice, size_t begin, size_t end, RiceTermSums& sums) const {
+    const size_t count = end - begin;
+    // Clamping happens here rather than in the term loop: float min/max
+    // become branches there and stop it from vectorizing. Intervals are whole
+    // milliseconds or infinite, so the clamped copies keep every pow argument
+    // finite and positive.
+    std::vector<float> interval(count), colInterval(count), clampedInterval(count), clampedColInterval(count);
+    std::vector<float> colActive(count), activeBase(count), pattern(count), simul(count);
+    for (size_t i = 0; i < count; ++i) {
+        const CalculatedNote& n = *rice[begin + i];
+        interval[i] = static_cast<float>(n.msSincePrev);
+        colInterval[i] = static_cast<float>(n.msSincePrevCol);
+        clampedInterval[i] = std::clamp(interval[i], 1.0f, 1e6f);
+        clampedColInterval[i] = std::clamp(colInterval[i], 1.0f, 1e6f);
+        colActive[i] = static_cast<float>(n.colActive);
+        activeBase[i] = std::max(colActive[i], 1.0f);
+        pattern[i] = (n.colChange ? 1.2f : 1.0f) * (n.handSimul ? 1.3f : 1.0f);
+        simul[i] = n.handSimul ? 1.0f : 0.0f;
+    }
 
-    std::map<int, int> timeToChordSize;
-    for (const auto& n : processedNotes) {
-        if (n.type == TAP || n.type == HOLD_START) {
-            timeToChordSize[n.time]++;
+    const float jackMin = static_cast<float>(config.JACK_MIN_INTERVAL_MS);
+    const float log2JackMin = std::log2(jackMin);
+    const float log2Of80 = std::log2(80.0f);
+    const float log2Of150 = std::log2(150.0f);
+    const float log2Of250 = std::log2(250.0f);
+    const float log2Of300 = std::log2(300.0f);
+    float* stream = sums.stream.terms.data() + begin;
+    float* jumpstream = sums.jumpstream.terms.data() + begin;
+    float* handstream = sums.handstream.terms.data() + begin;
+    float* jack = sums.jack.terms.data() + begin;
+    float* chordjack = sums.chordjack.terms.data() + begin;
+    for (size_t i = 0; i < count; ++i) {
+        // keep() zeroes whatever the reference loops would skip.
+        float rawInterval = interval[i];
+        float rawColInterval = colInterval[i];
+        float active = colActive[i];
+        bool hasInterval = rawInterval > 0.0f;
+        bool isJack = (rawColInterval > 0.0f) & (rawColInterval < jackMin);
+        bool under150 = rawInterval < 150.0f;
+        bool under250 = rawInterval < 250.0f;
+        bool under300 = rawInterval < 300.0f;
+        bool upTo2 = active <= 2.0f;
+
+        float log2Interval = fastLog2(clampedInterval[i]);
+        float log2JackRatio = log2JackMin - fastLog2(clampedColInterval[i]);
+        float activePow = fastPow(activeBase[i], 1.5f);
+
+        float streamFast = fastExp2(0.65f * (log2Of80 - log2Interval));
+        float streamSlow = fastExp2(0.4f * (log2Of250 - log2Interval));
+        float streamSpeed = keep(under150, streamFast) + keep(!under150 & under250, streamSlow);
+        stream[i] = keep(hasInterval & upTo2, streamSpeed * pattern[i]);
+
+        float jumpFast = fastExp2(0.4f * (log2Of300 - log2Interval));
+        float jumpSpeed = keep(under300, jumpFast) + keep(!under300, 1.0f);
+        jumpstream[i] = keep(hasInterval & (active >= 2.0f) & (active <= 3.0f), active * active * jumpSpeed);
+
+        float handFast = fastExp2(0.5f * (log2Of250 - log2Interval));
+        float handSpeed = keep(under250, handFast) + keep(!under250, 1.0f);
+        float jackPenalty = keep(isJack, fastExp2(-1.2f * log2JackRatio)) + keep(!isJack, 1.0f);
+        float roll = keep(upTo2 & under150, fastExp2(0.4f * (log2Of150 - log2Interval)));
+        float simulBonus = keep(simul[i] > 0.0f, 1.5f) + keep(!(simul[i] > 0.0f), 1.0f);
+        float hand = roll + activePow * handSpeed * simulBonus * jackPenalty;
+        handstream[i] = keep(hasInterval & ((active >= 3.0f) | (simul[i] > 0.0f)), hand);
+
+        jack[i] = keep(isJack, fastExp2(1.2f * log2JackRatio) * (1.0f + active * 0.5f));
+        chordjack[i] = keep(isJack & (active > 1.0f), fastExp2(1.1f * log2JackRatio) * activePow);
+    }
+}
+
+// Redoes every running total past the first `from` rice notes.
+void DifficultyCalculator::accumulateRiceTerms(RiceTermSums& sums, size_t from) const {
+    for (RiceKernelTerms* kernel : {&sums.stream, &sums.jumpstream, &sums.handstream, &sums.jack, &sums.chordjack}) {
+        const size_t count = kernel->terms.size();
+        kernel->sums.resize(count + 1);
+        kernel->sums[0] = 0.0;
+        for (size_t i = from; i < count; ++i) kernel->sums[i + 1] = kernel->sums[i] + kernel->terms[i];
+    }
+}
+
+DifficultyCalculator::PreparedNotes DifficultyCalculator::prepareNotes(const ChartData& chartData) const {
+    PreparedNotes prepared;
+    prepared.times.reserve(chartData.notes->size());
+    prepared.notes.reserve(chartData.notes->size());
+    prepareRange(*chartData.notes, 0, chartData.notes->size(), chartData.keyCount, prepared);
+    return prepared;
+}
+
+// Appends noteData[begin, end) to `prepared`.
+void DifficultyCalculator::prepareRange(const NoteData& noteData, size_t begin, size_t end, int keyCount, PreparedNotes& prepared) const {
+    std::span<const float> times = noteData.times();
+    std::span<const uint8_t> columns = noteData.columns();
+    std::span<const uint8_t> types = noteData.types();
+
+    double halfKey = keyCount / 2.0;
+    for (size_t i = begin; i < end; ++i) {
+        NoteType type = static_cast<NoteType>(types[i]);
+        if (type == MINE) continue;
+
+        CalculatedNote note{0, columns[i], type};
+        if (type != HOLD_END) {
+            note.isRice = (type == TAP);
+            note.isLN = (type == HOLD_START);
+            note.isLeftCol = note.column < halfKey;
+            note.isRightCol = note.column >= halfKey;
         }
+        prepared.times.push_back(times[i]);
+        prepared.notes.push_back(note);
+    }
+}
+
+template <typename Layout>
+std::vector<CalculatedNote> DifficultyCalculator::extractFeatures(const PreparedNotes& prepared, const Layout& layout, float rate) const {
+    std::vector<CalculatedNote> processedNotes = prepared.notes;
+    extractFeatureRange(prepared, processedNotes, 0, processedNotes.size(), layout, rate);
+    return processedNotes;
+}
+
+// Recomputes processedNotes[begin, end) from `prepared`. Both ends must sit
+// between runs of equal scaled time. Notes before `begin` are taken as done
+// and supply the previous note and each column's last hit.
+template <typename Layout>
+void DifficultyCalculator::extractFeatureRange(const PreparedNotes& prepared, std::vector<CalculatedNote>& processedNotes, size_t begin, size_t end, const Layout& layout, float rate) const {
+    for (size_t i = begin; i < end; ++i) {
+        processedNotes[i] = prepared.notes[i];
+        processedNotes[i].time = static_cast<int>(prepared.times[i] / rate);
     }
 
-    std::vector<double> lastHitTimeByColumn(keyCount, -std::numeric_limits<double>::infinity());
-    CalculatedNote* prevNote = nullptr;
+    // Scaled times stay sorted, so notes sharing a timestamp are adjacent.
+    for (size_t runStart = begin; runStart < end;) {
+        size_t runEnd = runStart;
+        int chordSize = 0;
+        for (; runEnd < end && processedNotes[runEnd].time == processedNotes[runStart].time; ++runEnd) {
+            NoteType type = processedNotes[runEnd].type;
+            if (type == TAP || type == HOLD_START) chordSize++;
+        }
+        for (size_t i = runStart; i < runEnd; ++i) {
+            processedNotes[i].colActive = chordSize;
+        }
+        runStart = runEnd;
+    }
 
-    for (auto& note : processedNotes) {
+    auto lastHitTimeByColumn = layout.perColumn(-std::numeric_limits<double>::infinity());
+    const CalculatedNote* prevNote = nullptr;
+
+    // Stops as soon as the previous note and every column have been seen.
+    size_t columnsFound = 0;
+    for (size_t i = begin; i-- > 0 && (!prevNote || columnsFound < layout.columns());) {
+        const CalculatedNote& note = processedNotes[i];
         if (note.type == HOLD_END) continue;
+        if (!prevNote) prevNote = &note;
+        if (lastHitTimeByColumn[note.column] == -std::numeric_limits<double>::infinity()) {
+            lastHitTimeByColumn[note.column] = note.time;
+            columnsFound++;
+        }
+    }
 
-        note.colActive = timeToChordSize[note.time];
-        note.isChord = note.colActive > 1;
-        note.isRice = (note.type == TAP);
-        note.isLN = (note.type == HOLD_START);
+    for (size_t i = begin; i < end; ++i) {
+        CalculatedNote& note = processedNotes[i];
+        if (note.type == HOLD_END) {
+            note.colActive = 0;
+            continue;
+        }
 
+        note.isChord = note.colActive > 1;
         note.msSincePrev = std::numeric_limits<double>::infinity();
-        note.colChange = false;
-        note.handSimul = false;
-
-        double halfKey = keyCount / 2.0;
-        note.isLeftCol = note.column < halfKey;
-        note.isRightCol = note.column >= halfKey;
 
         if (prevNote) {
             note.msSincePrev = (double)note.time - prevNote->time;
             note.colChange = note.column != prevNote->column;
             
-            bool prevLeft = prevNote->column < halfKey;
-            bool prevRight = prevNote->column >= halfKey;
-            
-            if ((note.isLeftCol && prevRight) || (note.isRightCol && prevLeft)) {
+            if (layout.isLeftHand(note.column) != layout.isLeftHand(prevNote->column)) {
                 note.handSimul = true;
             }
         }
@@ -70,18 +340,40 @@ void DifficultyCalculator::extractFeatures(ChartData& chartData, float rate) {
     }
 }
 
-double DifficultyCalculator::getBpmAt(int time, const ChartData& chartData, float rate) {
-    if (chartData.timingPoints.empty()) return 60.0 * rate;
-    double bpm = chartData.timingPoints[0].bpm;
-    for (const auto& tp : chartData.timingPoints) {
-        int adjustedTime = static_cast<int>(tp.time / rate);
-        if (adjustedTime <= time) bpm = tp.bpm;
-        else break;
+// `cursor` is the timing point found by the previous call; times must not
+// decrease between calls that share it.
+double DifficultyCalculator::getBpmAt(int time, const ChartData& chartData, float rate, size_t& cursor) const {
+    const auto& timingPoints = chartData.timingPoints;
+    if (timingPoints.empty()) return 60.0 * rate;
+    while (cursor + 1 < timingPoints.size() && static_cast<int>(timingPoints[cursor + 1].time / rate) <= time) {
+        cursor++;
     }
-    return bpm * rate;
+    return timingPoints[cursor].bpm * rate;
+}
+
+// Turn a window's summed per-note score into a skill value; shared by the
+// reference kernels below and the fast per-note terms.
+double DifficultyCalculator::streamSkill(double score, double durationS) const {
+    return std::pow(std::pow(score / durationS, 0.85) * 0.7, config.RICE_SKILL_EXPONENT);
+}
+
+double DifficultyCalculator::jumpstreamSkill(double score, double durationS) const {
+    return std::pow(std::pow(score / durationS, 0.7) * 0.7, config.RICE_SKILL_EXPONENT);
+}
+
+double DifficultyCalculator::handstreamSkill(double score, double durationS) const {
+    return std::pow(std::pow(score / durationS, 0.8) * 0.75, config.RICE_SKILL_EXPONENT);
+}
+
+double DifficultyCalculator::jackSkill(double score, int keyCount, double durationS) const {
+    return std::pow(std::pow(score / durationS / keyCount, 0.7) * 0.9, config.RICE_SKILL_EXPONENT);
 }
 
-double DifficultyCalculator::calcStream(const std::vector<const CalculatedNote*>& segment, double durationS) {
+double DifficultyCalculator::chordjackSkill(double score, int keyCount, double durationS) const {
+    return std::pow(std::pow(score / durationS / keyCount, 0.6), config.RICE_SKILL_EXPONENT);
+}
+
+double DifficultyCalculator::calcStream(NoteSpan segment, double durationS) const {
     if (segment.empty() || durationS <= 0) return 0;
     double score = 0;
     for (const auto* n : segment) {
@@ -98,10 +390,10 @@ double DifficultyCalculator::calcStream(const std::vector<const CalculatedNote*>
 
         score += speedFactor * patternFactor;
     }
-    return std::pow(std::pow(score / durationS, 0.85) * 0.7, config.RICE_SKILL_EXPONENT);
+    return streamSkill(score, durationS);
 }
 
-double DifficultyCalculator::calcJumpstream(const std::vector<const CalculatedNote*>& segment, double durationS) {
+double DifficultyCalculator::calcJumpstream(NoteSpan segment, double durationS) const {
     if (segment.empty() || durationS <= 0) return 0;
     double score = 0;
     for (const auto* n : segment) {
@@ -114,10 +406,10 @@ double DifficultyCalculator::calcJumpstream(const std::vector<const CalculatedNo
             score += std::pow(n->colActive, 2) * speedFactor;
         }
     }
-    return std::pow(std::pow(score / durationS, 0.7) * 0.7, config.RICE_SKILL_EXPONENT);
+    return jumpstreamSkill(score, durationS);
 }
 
-double DifficultyCalculator::calcHandstream(const std::vector<const CalculatedNote*>& segment, double durationS) {
+double DifficultyCalculator::calcHandstream(NoteSpan segment, double durationS) const {
     if (segment.empty() || durationS <= 0) return 0;
     double score = 0;
     for (const auto* n : segment) {
@@ -141,10 +433,10 @@ double DifficultyCalculator::calcHandstream(const std::vector<const CalculatedNo
             score += std::pow(n->colActive, 1.5) * speedFactor * (n->handSimul ? 1.5 : 1.0) * jackPenalty;
         }
     }
-    return std::pow(std::pow(score / durationS, 0.8) * 0.75, config.RICE_SKILL_EXPONENT);
+    return handstreamSkill(score, durationS);
 }
 
-double DifficultyCalculator::calcJack(const std::vector<const CalculatedNote*>& segment, int keyCount, double durationS) {
+double DifficultyCalculator::calcJack(NoteSpan segment, int keyCount, double durationS) const {
     if (segment.empty() || durationS <= 0) return 0;
     double score = 0;
     for (const auto* n : segment) {
@@ -156,10 +448,10 @@ double DifficultyCalculator::calcJack(const std::vector<const CalculatedNote*>&
             score += std::pow(config.JACK_MIN_INTERVAL_MS / colInt, 1.2) * (1.0 + (n->colActive * 0.5));
         }
     }
-    return std::pow(std::pow(score / durationS / keyCount, 0.7) * 0.9, config.RICE_SKILL_EXPONENT);
+    return jackSkill(score, keyCount, durationS);
 }
 
-double DifficultyCalculator::calcChordjack(const std::vector<const CalculatedNote*>& segment, int keyCount, double durationS) {
+double DifficultyCalculator::calcChordjack(NoteSpan segment, int keyCount, double durationS) const {
     if (segment.empty() || durationS <= 0) return 0;
     double score = 0;
     for (const auto* n : segment) {
@@ -173,10 +465,10 @@ double DifficultyCalculator::calcChordjack(const std::vector<const CalculatedNot
             score += speedFactor * chordFactor;
         }
     }
-    return std::pow(std::pow(score / durationS / keyCount, 0.6), config.RICE_SKILL_EXPONENT);
+    return chordjackSkill(score, keyCount, durationS);
 }
 
-double DifficultyCalculator::calcTechnical(const std::vector<const CalculatedNote*>& segment) {
+double DifficultyCalculator::calcTechnical(NoteSpan segment) const {
     if (segment.size() <= 1) return 0;
     std::vector<double> intervals;
     for (size_t i = 1; i < segment.size(); ++i) {
@@ -203,13 +495,13 @@ double DifficultyCalculator::calcTechnical(const std::vector<const CalculatedNot
     return std::pow(raw * 0.8, config.RICE_SKILL_EXPONENT);
 }
 
-double DifficultyCalculator::calcLnDensity(const std::vector<const CalculatedNote*>& starts, double durationS) {
+double DifficultyCalculator::calcLnDensity(NoteSpan starts, double durationS) const {
     if (starts.empty() || durationS <= 0) return 0;
     double lnps = starts.size() / durationS;
     return std::pow(std::pow(lnps, 1.1) * 1.2, config.LN_SKILL_EXPONENT);
 }
 
-double DifficultyCalculator::calcLnSpeed(const std::vector<const CalculatedNote*>& starts) {
+double DifficultyCalculator::calcLnSpeed(NoteSpan starts) const {
     double score = 0;
     for (size_t i = 1; i < starts.size(); ++i) {
         double interval = (double)starts[i]->time - starts[i-1]->time;
@@ -220,7 +512,64 @@ double DifficultyCalculator::calcLnSpeed(const std::vector<const CalculatedNote*
     return std::pow(std::pow(score, 0.6), config.LN_SKILL_EXPONENT);
 }
 
-double DifficultyCalculator::calcLnShields(const std::vector<const CalculatedNote*>& rice, const std::vector<const CalculatedNote*>& lnEvents) {
+// Every rice note strictly inside a completed hold scores by its column
+// distance from the hold, so only the per-distance counts matter. Rice is
+// swept once alongside the LN events with running per-column counts; a hold
+// start snapshots them and its end takes the difference.
+template <typename Layout>
+double DifficultyCalculator::calcLnShields(NoteSpan rice, NoteSpan lnEvents, const Layout& layout) const {
+    const size_t columns = layout.columns();
+    if (lnEvents.size() < 2 || columns == 0) return 0;
+
+    auto riceBefore = layout.perColumn(0);
+    auto riceUpTo = layout.perColumn(0);
+    auto startCounts = layout.perColumnPair(0);
+    auto startTimes = layout.perColumn(0);
+    auto activeLNs = layout.perColumn(false);
+    auto shieldsByDistance = layout.perColumn(int64_t{0});
+    size_t beforeIndex = 0;
+    size_t upToIndex = 0;
+
+    for (const auto* n : lnEvents) {
+        size_t column = static_cast<size_t>(n->column);
+        if (column >= columns) continue;
+
+        if (n->type == HOLD_START) {
+            for (; upToIndex < rice.size() && rice[upToIndex]->time <= n->time; ++upToIndex) {
+                size_t riceColumn = static_cast<size_t>(rice[upToIndex]->column);
+                if (riceColumn < columns) riceUpTo[riceColumn]++;
+            }
+            std::copy(riceUpTo.begin(), riceUpTo.end(), startCounts.begin() + column * columns);
+            startTimes[column] = n->time;
+            activeLNs[column] = true;
+        } else if (n->type == HOLD_END && activeLNs[column]) {
+            for (; beforeIndex < rice.size() && rice[beforeIndex]->time < n->time; ++beforeIndex) {
+                size_t riceColumn = static_cast<size_t>(rice[beforeIndex]->column);
+                if (riceColumn < columns) riceBefore[riceColumn]++;
+            }
+            if (n->time > startTimes[column]) {
+                const int* atStart = startCounts.data() + column * columns;
+                for (size_t other = 0; other < columns; ++other) {
+                    if (other == column) continue;
+                    size_t dist = other > column ? other - column : column - other;
+                    shieldsByDistance[dist] += riceBefore[other] - atStart[other];
+                }
+            }
+            activeLNs[column] = false;
+        }
+    }
+
+    double score = 0;
+    for (size_t dist = 1; dist < columns; ++dist) {
+        double distFactor = 1.0 + (1.0 / (dist + 0.1));
+        score += 1.2 * distFactor * shieldsByDistance[dist];
+    }
+    return std::pow(std::pow(score / 50.0, 1.2), config.LN_SKILL_EXPONENT);
+}
+
+// The shields loop calcLnShields replaced, unchanged apart from taking
+// spans: every completed hold rescans the whole window's rice.
+double DifficultyCalculator::calcLnShieldsPairwise(NoteSpan rice, NoteSpan lnEvents) const {
     if (lnEvents.size() < 2) return 0;
     std::map<int, const CalculatedNote*> activeLNs;
     double score = 0;
@@ -245,7 +594,7 @@ double DifficultyCalculator::calcLnShields(const std::vector<const CalculatedNot
     return std::pow(std::pow(score / 50.0, 1.2), config.LN_SKILL_EXPONENT);
 }
 
-double DifficultyCalculator::calcLnComplexity(const std::vector<const CalculatedNote*>& lnEvents, int keyCount) {
+double DifficultyCalculator::calcLnComplexity(NoteSpan lnEvents, int keyCount) const {
     double score = 0;
     for (size_t i = 1; i < lnEvents.size(); ++i) {
         double interval = (double)lnEvents[i]->time - lnEvents[i-1]->time;
@@ -261,16 +610,24 @@ double DifficultyCalculator::calcLnComplexity(const std::vector<const Calculated
     return std::pow(std::pow(score, 0.7) / keyCount, config.LN_SKILL_EXPONENT);
 }
 
-double DifficultyCalculator::calcStamina(const std::vector<SkillResult>& segments) {
+// Entry i is the average weighted rice score of segments [i, i + segments
+// per stamina window). Only entries whose window overlaps segments
+// [first, last) are recomputed.
+void DifficultyCalculator::refreshStaminaAverages(const std::vector<SkillResult>& segments, std::vector<double>& averages, size_t first, size_t last) const {
     double windowLen = config.STAMINA_WINDOW_S * 1000.0;
     int segsPerWindow = std::floor(windowLen / config.WINDOW_OVERLAP_MS);
     
-    if (segments.size() < (size_t)segsPerWindow) return 0;
+    if (segments.size() < (size_t)segsPerWindow) {
+        averages.clear();
+        return;
+    }
+    averages.resize(segments.size() - segsPerWindow + 1);
 
-    double maxStamina = 0;
     double wS = 1.1, wJS = 1.0, wHS = 1.1, wJ = 1.2, wCJ = 0.7, wT = 0.9;
 
-    for (size_t i = 0; i <= segments.size() - segsPerWindow; ++i) {
+    size_t from = first >= (size_t)segsPerWindow ? first - segsPerWindow + 1 : 0;
+    size_t to = std::min(last, averages.size());
+    for (size_t i = from; i < to; ++i) {
         double windowSum = 0;
         for (int j = 0; j < segsPerWindow; ++j) {
             const auto& s = segments[i + j];
@@ -278,7 +635,15 @@ double DifficultyCalculator::calcStamina(const std::vector<SkillResult>& segment
                             + (s.jack * wJ) + (s.chordjack * wCJ) + (s.technical * wT);
             windowSum += segScore;
         }
-        double windowAvg = windowSum / segsPerWindow;
+        averages[i] = windowSum / segsPerWindow;
+    }
+}
+
+double DifficultyCalculator::staminaFromAverages(const std::vector<double>& averages) const {
+    if (averages.empty()) return 0;
+
+    double maxStamina = 0;
+    for (double windowAvg : averages) {
         maxStamina = std::max(maxStamina, windowAvg);
     }
 
@@ -286,72 +651,203 @@ double DifficultyCalculator::calcStamina(const std::vector<SkillResult>& segment
 }
 
 
-FinalResult DifficultyCalculator::calculate(ChartData& chartData, float rate) {
+FinalResult DifficultyCalculator::calculate(const ChartData& chartData, float rate) const {
     if (rate <= 0.0f) rate = 1.0f;
-    
-    extractFeatures(chartData, rate);
+    return withKeyLayout(chartData.keyCount, specializedKeyLayouts, [&](const auto& layout) {
+        return evaluate(chartData, extractFeatures(prepareNotes(chartData), layout, rate), layout, rate);
+    });
+}
 
-    int keyCount = chartData.keyCount;
-    if (processedNotes.empty()) {
-        return FinalResult{"", "", 1.0f, keyCount, 0.0, SkillResult{}, 0.0, 0.0, 0.0, 0.0};
+std::vector<FinalResult> DifficultyCalculator::calculateRates(const ChartData& chartData, const std::vector<float>& rates, int threadCount) const {
+    std::vector<FinalResult> results(rates.size());
+    if (rates.empty()) return results;
+
+    const PreparedNotes prepared = prepareNotes(chartData);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        withKeyLayout(chartData.keyCount, specializedKeyLayouts, [&](const auto& layout) {
+            for (size_t i = next.fetch_add(1); i < rates.size(); i = next.fetch_add(1)) {
+                float rate = rates[i] > 0.0f ? rates[i] : 1.0f;
+                results[i] = evaluate(chartData, extractFeatures(prepared, layout, rate), layout, rate);
+            }
+        });
+    };
+
+    if (threadCount <= 0) threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    size_t workers = std::min(rates.size(), static_cast<size_t>(threadCount));
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+
+    for (auto& thread : threads) {
+        thread.join();
     }
+    return results;
+}
 
-    std::vector<const CalculatedNote*> ricePtrs;
-    std::vector<const CalculatedNote*> lnEventPtrs;
-    std::vector<const CalculatedNote*> lnStartPtrs;
+std::vector<float> DifficultyCalculator::rateLadder(float minRate, float maxRate, float step) {
+    std::vector<float> rates;
+    if (step <= 0.0f || maxRate < minRate) return rates;
 
-    for (const auto& n : processedNotes) {
-        if (n.isRice) ricePtrs.push_back(&n);
-        if (n.type == HOLD_START || n.type == HOLD_END) lnEventPtrs.push_back(&n);
-        if (n.type == HOLD_START) lnStartPtrs.push_back(&n);
+    int steps = static_cast<int>(std::floor((maxRate - minRate) / step + 1e-3f));
+    for (int i = 0; i <= steps; ++i) {
+        rates.push_back(std::round((minRate + i * step) * 100.0f) / 100.0f);
+    }
+    return rates;
+}
+
+template <typename Layout>
+FinalResult DifficultyCalculator::evaluate(const ChartData& chartData, const std::vector<CalculatedNote>& processedNotes, const Layout& layout, float rate) const {
+    if (processedNotes.empty()) {
+        FinalResult fr{};
+        fr.playbackRate = rate;
+        fr.keyCount = chartData.keyCount;
+        return fr;
     }
 
+    return aggregate(chartData, evaluateWindows(chartData, processedNotes, layout, rate), processedNotes.front().time, rate);
+}
+
+template <typename Layout>
+DifficultyCalculator::WindowSkills DifficultyCalculator::evaluateWindows(const ChartData& chartData, const std::vector<CalculatedNote>& processedNotes, const Layout& layout, float rate) const {
+    const NoteLists lists = buildNoteLists(processedNotes);
+
     int startTime = processedNotes.front().time;
     int endTime = processedNotes.back().time;
 
-    std::vector<SkillResult> segmentResults;
-    SkillResult maxSkills;
+    // Window bounds only move forward, so each list keeps a [begin, end)
+    // pair that advances with the window instead of being rescanned.
+    struct SlidingWindow {
+        const std::vector<const CalculatedNote*>& notes;
+        size_t begin = 0;
+        size_t end = 0;
+
+        NoteSpan advance(double windowStart, double windowEnd) {
+            while (begin < notes.size() && notes[begin]->time < windowStart) begin++;
+            end = std::max(end, begin);
+            while (end < notes.size() && notes[end]->time < windowEnd) end++;
+            return NoteSpan(notes.data() + begin, end - begin);
+        }
+    };
+
+    SlidingWindow riceWindow{lists.rice};
+    SlidingWindow lnEventWindow{lists.lnEvents};
+    SlidingWindow lnStartWindow{lists.lnStarts};
+    size_t bpmCursor = 0;
+
+    WindowSkills windows;
+    windows.starts = windowStarts(startTime, endTime);
+    windows.skills.reserve(windows.starts.size());
+    for (double ct : windows.starts) {
+        double wEnd = ct + config.WINDOW_MS;
+        double durMs = std::min((double)wEnd, (double)endTime) - ct;
+
+        WindowNotes window;
+        window.rice = riceWindow.advance(ct, wEnd);
+        window.lnEvents = lnEventWindow.advance(ct, wEnd);
+        window.lnStarts = lnStartWindow.advance(ct, wEnd);
+        window.riceBegin = riceWindow.begin;
+        window.riceEnd = riceWindow.end;
+
+        double chartBpm = getBpmAt(ct, chartData, rate, bpmCursor);
+        windows.skills.push_back(evaluateWindow(lists, window, durMs / 1000.0, chartBpm, chartData.keyCount, layout));
+    }
+
+    refreshWindowTotals(windows, 0, windows.skills.size());
+    return windows;
+}
 
+// Windows shorter than a second are skipped.
+std::vector<double> DifficultyCalculator::windowStarts(int startTime, int endTime) const {
+    std::vector<double> starts;
     for (double ct = startTime; ct <= endTime; ct += config.WINDOW_OVERLAP_MS) {
         double wEnd = ct + config.WINDOW_MS;
         double durMs = std::min((double)wEnd, (double)endTime) - ct;
         if (durMs < 1000) continue;
-        double durSec = durMs / 1000.0;
-
-        auto getSubset = [&](const std::vector<const CalculatedNote*>& src) {
-            std::vector<const CalculatedNote*> sub;
-            for (const auto* n : src) {
-                if (n->time >= ct && n->time < wEnd) sub.push_back(n);
-            }
-            return sub;
-        };
+        starts.push_back(ct);
+    }
+    return starts;
+}
 
-        auto segRice = getSubset(ricePtrs);
-        auto segLns = getSubset(lnEventPtrs);
-        auto segLnStarts = getSubset(lnStartPtrs);
+DifficultyCalculator::NoteLists DifficultyCalculator::buildNoteLists(const std::vector<CalculatedNote>& processedNotes) const {
+    NoteLists lists;
+    collectNotes(processedNotes, lists);
+    if (kernels == DifficultyKernels::FAST) lists.riceTerms = computeRiceTermSums(lists.rice);
+    return lists;
+}
 
-        double chartBpm = getBpmAt(ct, chartData, rate);
-        double nps = segRice.size() / durSec;
-        double densityBpm = nps * 60.0;
-        double finalBpm = std::min(chartBpm, densityBpm);
-        finalBpm = std::min(finalBpm, config.MAX_BPM_RATIO * config.BPM_BASE);
-        double bpmScale = std::pow(finalBpm / config.BPM_BASE, config.BPM_SCALE_EXPONENT);
+// Refills the note lists only; riceTerms is left alone.
+void DifficultyCalculator::collectNotes(const std::vector<CalculatedNote>& processedNotes, NoteLists& lists) const {
+    lists.rice.clear();
+    lists.lnEvents.clear();
+    lists.lnStarts.clear();
+    for (const auto& n : processedNotes) {
+        if (n.isRice) lists.rice.push_back(&n);
+        if (n.type == HOLD_START || n.type == HOLD_END) lists.lnEvents.push_back(&n);
+        if (n.type == HOLD_START) lists.lnStarts.push_back(&n);
+    }
+}
 
-        SkillResult sr;
+template <typename Layout>
+SkillResult DifficultyCalculator::evaluateWindow(const NoteLists& lists, const WindowNotes& window, double durSec, double chartBpm, int keyCount, const Layout& layout) const {
+    NoteSpan segRice = window.rice;
+    double nps = segRice.size() / durSec;
+    double densityBpm = nps * 60.0;
+    double finalBpm = std::min(chartBpm, densityBpm);
+    finalBpm = std::min(finalBpm, config.MAX_BPM_RATIO * config.BPM_BASE);
+    double bpmScale = std::pow(finalBpm / config.BPM_BASE, config.BPM_SCALE_EXPONENT);
+
+    SkillResult sr;
+    if (kernels == DifficultyKernels::FAST) {
+        auto windowSum = [&](const std::vector<double>& sums) { return sums[window.riceEnd] - sums[window.riceBegin]; };
+        sr.stream = streamSkill(windowSum(lists.riceTerms.stream.sums), durSec) * bpmScale;
+        sr.jumpstream = jumpstreamSkill(windowSum(lists.riceTerms.jumpstream.sums), durSec) * bpmScale;
+        sr.handstream = handstreamSkill(windowSum(lists.riceTerms.handstream.sums), durSec) * bpmScale;
+        sr.jack = jackSkill(windowSum(lists.riceTerms.jack.sums), keyCount, durSec) * bpmScale;
+        sr.chordjack = chordjackSkill(windowSum(lists.riceTerms.chordjack.sums), keyCount, durSec) * bpmScale;
+    } else {
         sr.stream = calcStream(segRice, durSec) * bpmScale;
         sr.jumpstream = calcJumpstream(segRice, durSec) * bpmScale;
         sr.handstream = calcHandstream(segRice, durSec) * bpmScale;
         sr.jack = calcJack(segRice, keyCount, durSec) * bpmScale;
         sr.chordjack = calcChordjack(segRice, keyCount, durSec) * bpmScale;
-        sr.technical = calcTechnical(segRice) * bpmScale;
-        
-        sr.density = calcLnDensity(segLnStarts, durSec) * bpmScale;
-        sr.speed = calcLnSpeed(segLnStarts) * bpmScale;
-        sr.shields = calcLnShields(segRice, segLns) * bpmScale;
-        sr.complexity = calcLnComplexity(segLns, keyCount) * bpmScale;
+    }
+    sr.technical = calcTechnical(segRice) * bpmScale;
+    
+    sr.density = calcLnDensity(window.lnStarts, durSec) * bpmScale;
+    sr.speed = calcLnSpeed(window.lnStarts) * bpmScale;
+    sr.shields = (pairwiseLnShields ? calcLnShieldsPairwise(segRice, window.lnEvents) : calcLnShields(segRice, window.lnEvents, layout)) * bpmScale;
+    sr.complexity = calcLnComplexity(window.lnEvents, keyCount) * bpmScale;
+    return sr;
+}
+
+// Whether window skills computed under `a` are valid under `b`. The rating
+// weights and P_NORM_EXPONENT are only read by aggregate() (and the strain
+// curve, which has its own flag), so they may differ.
+bool DifficultyCalculator::sameWindowSettings(const DifficultyConfig& a, const DifficultyConfig& b) {
+    auto windowOnly = [](DifficultyConfig config) {
+        config.W_RICE_FINAL = config.W_LN_FINAL = 0.0;
+        config.P_NORM_EXPONENT = 0.0;
+        config.W_RICE_STREAM = config.W_RICE_JUMPSTREAM = config.W_RICE_HANDSTREAM = config.W_RICE_STAMINA = 0.0;
+        config.W_RICE_JACK = config.W_RICE_CHORDJACK = config.W_RICE_TECHNICAL = 0.0;
+        config.W_LN_DENSITY = config.W_LN_SPEED = config.W_LN_SHIELDS = config.W_LN_COMPLEXITY = 0.0;
+        return config;
+    };
+    DifficultyConfig windowA = windowOnly(a);
+    DifficultyConfig windowB = windowOnly(b);
+    return std::memcmp(&windowA, &windowB, sizeof(DifficultyConfig)) == 0;
+}
 
-        segmentResults.push_back(sr);
+FinalResult DifficultyCalculator::aggregate(const ChartData& chartData, const WindowSkills& windows, int startTime, float rate) const {
+    int keyCount = chartData.keyCount;
+    const std::vector<SkillResult>& segmentResults = windows.skills;
 
+    SkillResult maxSkills;
+    for (const auto& sr : segmentResults) {
         maxSkills.stream = std::max(maxSkills.stream, sr.stream);
         maxSkills.jumpstream = std::max(maxSkills.jumpstream, sr.jumpstream);
         maxSkills.handstream = std::max(maxSkills.handstream, sr.handstream);
@@ -364,7 +860,7 @@ FinalResult DifficultyCalculator::calculate(ChartData& chartData, float rate) {
         maxSkills.complexity = std::max(maxSkills.complexity, sr.complexity);
     }
 
-    maxSkills.stamina = calcStamina(segmentResults);
+    maxSkills.stamina = staminaFromAverages(windows.staminaAverages);
 
     double riceFinal = Utils::pNorm(
         {maxSkills.stream, maxSkills.jumpstream, maxSkills.handstream, maxSkills.jack, maxSkills.chordjack, maxSkills.technical, maxSkills.stamina},
@@ -427,8 +923,8 @@ FinalResult DifficultyCalculator::calculate(ChartData& chartData, float rate) {
 
     FinalResult fr;
     fr.playbackRate = rate;
-    fr.title = chartData.metadata["title"];
-    fr.difficulty = chartData.metadata["difficulty"];
+    fr.title = chartData.metadata.title;
+    fr.difficulty = chartData.metadata.difficulty;
     fr.keyCount = keyCount;
     fr.rawDiff = finalTotal;
     fr.skills = maxSkills;
@@ -438,5 +934,116 @@ FinalResult DifficultyCalculator::calculate(ChartData& chartData, float rate) {
     fr.minBPM = chartMinBPM;
     fr.maxBPM = chartMaxBPM;
 
+    if (strainCurves) {
+        fr.strain = buildStrainCurve(windows, startTime);
+    }
+
     return fr;
+}
+
+std::vector<CalculatedNote> DifficultyCalculator::processNotes(const ChartData& chartData, float rate) const {
+    return withKeyLayout(chartData.keyCount, specializedKeyLayouts, [&](const auto& layout) {
+        return extractFeatures(prepareNotes(chartData), layout, rate);
+    });
+}
+
+DifficultyCalculator::WindowSkills DifficultyCalculator::rateWindows(const ChartData& chartData, const std::vector<CalculatedNote>& processedNotes, float rate) const {
+    return withKeyLayout(chartData.keyCount, specializedKeyLayouts, [&](const auto& layout) {
+        return evaluateWindows(chartData, processedNotes, layout, rate);
+    });
+}
+
+void DifficultyCalculator::refreshFeatures(const PreparedNotes& prepared, std::vector<CalculatedNote>& processedNotes, size_t begin, size_t end, int keyCount, float rate) const {
+    withKeyLayout(keyCount, specializedKeyLayouts, [&](const auto& layout) {
+        extractFeatureRange(prepared, processedNotes, begin, end, layout, rate);
+    });
+}
+
+// Re-evaluates windows [first, last) in place, finding each window's notes
+// by binary search rather than sliding from the start of the chart.
+void DifficultyCalculator::refreshWindows(const ChartData& chartData, const NoteLists& lists, WindowSkills& windows, size_t first, size_t last, int endTime, float rate) const {
+    auto slice = [](const std::vector<const CalculatedNote*>& notes, double windowStart, double windowEnd, size_t& begin, size_t& end) {
+        auto before = [](const CalculatedNote* note, double time) { return note->time < time; };
+        begin = std::lower_bound(notes.begin(), notes.end(), windowStart, before) - notes.begin();
+        end = std::lower_bound(notes.begin() + begin, notes.end(), windowEnd, before) - notes.begin();
+        return NoteSpan(notes.data() + begin, end - begin);
+    };
+
+    withKeyLayout(chartData.keyCount, specializedKeyLayouts, [&](const auto& layout) {
+        size_t bpmCursor = 0;
+        for (size_t k = first; k < last; ++k) {
+            double ct = windows.starts[k];
+            double wEnd = ct + config.WINDOW_MS;
+            double durMs = std::min((double)wEnd, (double)endTime) - ct;
+
+            WindowNotes window;
+            size_t begin, end;
+            window.rice = slice(lists.rice, ct, wEnd, window.riceBegin, window.riceEnd);
+            window.lnEvents = slice(lists.lnEvents, ct, wEnd, begin, end);
+            window.lnStarts = slice(lists.lnStarts, ct, wEnd, begin, end);
+
+            double chartBpm = getBpmAt(ct, chartData, rate, bpmCursor);
+            windows.skills[k] = evaluateWindow(lists, window, durMs / 1000.0, chartBpm, chartData.keyCount, layout);
+        }
+    });
+}
+
+// Replaces the terms of `removed` rice notes at `begin` with those of the
+// `inserted` rice notes now there, then redoes the running totals from
+// `begin` on.
+void DifficultyCalculator::refreshRiceTerms(const std::vector<const CalculatedNote*>& rice, RiceTermSums& sums, size_t begin, size_t removed, size_t inserted) const {
+    for (RiceKernelTerms* kernel : {&sums.stream, &sums.jumpstream, &sums.handstream, &sums.jack, &sums.chordjack}) {
+        std::vector<float>& terms = kernel->terms;
+        terms.erase(terms.begin() + begin, terms.begin() + begin + removed);
+        terms.insert(terms.begin() + begin, inserted, 0.0f);
+    }
+    fillRiceTerms(rice, begin, begin + inserted, sums);
+    accumulateRiceTerms(sums, begin);
+}
+
+void DifficultyCalculator::refreshWindowTotals(WindowSkills& windows, size_t first, size_t last) const {
+    refreshStaminaAverages(windows.skills, windows.staminaAverages, first, last);
+    if (!strainCurves) return;
+
+    // Each window's strain is the same weighted p-norm the rating applies
+    // to the skill maxima, without stamina, which only exists chart-wide.
+    windows.riceStrain.resize(windows.skills.size());
+    windows.lnStrain.resize(windows.skills.size());
+    for (size_t i = first; i < last; ++i) {
+        const SkillResult& sr = windows.skills[i];
+        windows.riceStrain[i] = Utils::pNorm(
+            {sr.stream, sr.jumpstream, sr.handstream, sr.jack, sr.chordjack, sr.technical},
+            {config.W_RICE_STREAM, config.W_RICE_JUMPSTREAM, config.W_RICE_HANDSTREAM, config.W_RICE_JACK, config.W_RICE_CHORDJACK, config.W_RICE_TECHNICAL},
+            config.P_NORM_EXPONENT
+        );
+        windows.lnStrain[i] = Utils::pNorm(
+            {sr.density, sr.speed, sr.shields, sr.complexity},
+            {config.W_LN_DENSITY, config.W_LN_SPEED, config.W_LN_SHIELDS, config.W_LN_COMPLEXITY},
+            config.P_NORM_EXPONENT
+        );
+    }
+}
+
+// Samples are quantized against the highest strain of either kind.
+StrainCurve DifficultyCalculator::buildStrainCurve(const WindowSkills& windows, int startTime) const {
+    const std::vector<double>& rice = windows.riceStrain;
+    const std::vector<double>& ln = windows.lnStrain;
+    double peak = 0.0;
+    for (size_t i = 0; i < rice.size(); ++i) {
+        peak = std::max({peak, rice[i], ln[i]});
+    }
+
+    StrainCurve curve;
+    curve.startTime = startTime;
+    curve.stepMs = static_cast<float>(config.WINDOW_OVERLAP_MS);
+    curve.peak = static_cast<float>(peak);
+    curve.rice.resize(rice.size());
+    curve.ln.resize(rice.size());
+    if (peak > 0.0) {
+        for (size_t i = 0; i < rice.size(); ++i) {
+            curve.rice[i] = static_cast<uint8_t>(std::lround(rice[i] / peak * 255.0));
+            curve.ln[i] = static_cast<uint8_t>(std::lround(ln[i] / peak * 255.0));
+        }
+    }
+    return curve;
 }
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include <rhythm/DifficultyDatabase.h>
+#include <utils/Hash.h>
+#include <utils/Utils.h>
+#include <system/Logger.h>
+#include <SDL3/SDL.h>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+
+static constexpr char MAGIC[4] = {'V', 'S', 'D', 'B'};
+static constexpr size_t HEADER_SIZE = 16;
+// chartHash, rate, keyCount, then the 16 doubles in recordFields order.
+static constexpr size_t RECORD_SIZE = 8 + 4 + 4 + 16 * 8;
+// Sample count, startTime, stepMs and peak, then the rice samples followed by
+// the LN samples, one byte each.
+static constexpr size_t CURVE_HEADER_SIZE = 4 + 4 + 4 + 4;
+// Pending records are written once they reach this size, a few hundred
+// ratings with strain curves.
+static constexpr size_t WRITE_BATCH_BYTES = 64 * 1024;
+
+template <typename T>
+static void writeLittleEndian(std::string& out, T value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+    }
+}
+
+template <typename T>
+static T readLittleEndian(const char* data) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        bits |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+static std::string makeHeader(uint64_t configHash) {
+    std::string header(MAGIC, sizeof(MAGIC));
+    writeLittleEndian<uint32_t>(header, DifficultyDatabase::VERSION);
+    writeLittleEndian<uint64_t>(header, configHash);
+    return header;
+}
+
+static std::array<double*, 16> recordFields(FinalResult& result) {
+    return {
+        &result.rawDiff, &result.riceTotal, &result.lnTotal, &result.minBPM, &result.maxBPM,
+        &result.skills.stream, &result.skills.jumpstream, &result.skills.handstream, &result.skills.jack,
+        &result.skills.chordjack, &result.skills.technical, &result.skills.stamina,
+        &result.skills.density, &result.skills.speed, &result.skills.shields, &result.skills.complexity,
+    };
+}
+
+DifficultyDatabase::~DifficultyDatabase() {
+    close();
+}
+
+int DifficultyDatabase::rateKey(float rate) {
+    return static_cast<int>(std::lround(rate * 100.0f));
+}
+
+uint64_t DifficultyDatabase::configHash(const DifficultyCalculator& calculator) {
+    static_assert(std::is_trivially_copyable_v<DifficultyConfig>);
+    Hash::Xxh64 hasher(DifficultyCalculator::ALGORITHM_VERSION);
+    hasher.updateValue(calculator.getConfig());
+    hasher.updateValue(calculator.getKernels());
+    return hasher.digest();
+}
+
+bool DifficultyDatabase::open(const std::string& path, const DifficultyCalculator& calculator) {
+    close();
+
+    std::scoped_lock lock(mutex_, fileMutex_);
+    results_.clear();
+    pendingRecords_.clear();
+
+    const std::string header = makeHeader(configHash(calculator));
+    std::string content = Utils::readFile(path);
+    bool valid = content.size() >= HEADER_SIZE && content.compare(0, HEADER_SIZE, header) == 0;
+
+    size_t validSize = HEADER_SIZE;
+    if (valid) {
+        while (content.size() - validSize >= RECORD_SIZE + CURVE_HEADER_SIZE) {
+            const char* data = content.data() + validSize;
+            const char* curveData = data + RECORD_SIZE;
+            uint32_t samples = readLittleEndian<uint32_t>(curveData);
+            size_t recordSize = RECORD_SIZE + CURVE_HEADER_SIZE + 2 * static_cast<size_t>(samples);
+            if (content.size() - validSize < recordSize) break;
+
+            Key key{readLittleEndian<uint64_t>(data), readLittleEndian<int32_t>(data + 8)};
+
+            FinalResult result{};
+            result.playbackRate = key.rate / 100.0f;
+            result.keyCount = readLittleEndian<int32_t>(data + 12);
+            auto fields = recordFields(result);
+            for (size_t field = 0; field < fields.size(); ++field) {
+                *fields[field] = readLittleEndian<double>(data + 16 + field * 8);
+            }
+
+            StrainCurve& curve = result.strain;
+            curve.startTime = readLittleEndian<int32_t>(curveData + 4);
+            curve.stepMs = readLittleEndian<float>(curveData + 8);
+            curve.peak = readLittleEndian<float>(curveData + 12);
+            const uint8_t* sampleData = reinterpret_cast<const uint8_t*>(curveData + CURVE_HEADER_SIZE);
+            curve.rice.assign(sampleData, sampleData + samples);
+            curve.ln.assign(sampleData + samples, sampleData + 2 * samples);
+
+            results_[key] = std::move(result);
+            validSize += recordSize;
+        }
+    } else if (!content.empty()) {
+        GAME_LOG_INFO("Difficulty database " + path + " was written with another calculator version, config or kernel mode, starting over");
+    }
+
+    std::error_code ec;
+    std::filesystem::path filePath(path);
+    if (filePath.has_parent_path()) {
+        std::filesystem::create_directories(filePath.parent_path(), ec);
+    }
+
+    if (valid) {
+        // Drop a record cut short by a crash so appends start on a record.
+        if (content.size() != validSize) {
+            std::filesystem::resize_file(filePath, validSize, ec);
+        }
+        file_.open(path, std::ios::binary | std::ios::app);
+    } else {
+        file_.open(path, std::ios::binary | std::ios::trunc);
+        file_.write(header.data(), header.size());
+        file_.flush();
+    }
+
+    if (!file_.is_open() || !file_.good()) {
+        GAME_LOG_WARN("Could not open difficulty database " + path + ", results won't be kept");
+        file_.close();
+        return false;
+    }
+
+    GAME_LOG_INFO("Loaded " + std::to_string(results_.size()) + " difficulty results from " + path);
+    return true;
+}
+
+void DifficultyDatabase::close() {
+    stopPrerating();
+    writePendingRecords();
+
+    std::lock_guard<std::mutex> fileLock(fileMutex_);
+    if (file_.is_open()) {
+        file_.flush();
+        file_.close();
+    }
+}
+
+std::optional<FinalResult> DifficultyDatabase::find(const ChartData& chart, float rate) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = results_.find({chart.hash, rateKey(rate)});
+    if (it == results_.end()) return std::nullopt;
+
+    FinalResult result = it->second;
+    result.title = chart.metadata.title;
+    result.difficulty = chart.metadata.difficulty;
+    return result;
+}
+
+std::optional<double> DifficultyDatabase::findRawDiff(uint64_t chartHash, float rate) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = results_.find({chartHash, rateKey(rate)});
+    if (it == results_.end()) return std::nullopt;
+    return it->second.rawDiff;
+}
+
+bool DifficultyDatabase::contains(uint64_t chartHash, float rate) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return results_.count({chartHash, rateKey(rate)}) > 0;
+}
+
+size_t DifficultyDatabase::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return results_.size();
+}
+
+void DifficultyDatabase::insert(const ChartData& chart, const FinalResult& result) {
+    Key key{chart.hash, rateKey(result.playbackRate)};
+    std::string record = encodeRecord(key, result);
+
+    std::string batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!results_.emplace(key, result).second) return;
+
+        pendingRecords_ += record;
+        if (pendingRecords_.size() < WRITE_BATCH_BYTES) return;
+        batch.swap(pendingRecords_);
+    }
+    writeRecords(batch);
+}
+
+// Batches can land out of insert order; records don't depend on each other.
+void DifficultyDatabase::writeRecords(const std::string& records) {
+    std::lock_guard<std::mutex> fileLock(fileMutex_);
+    if (records.empty() || !file_.is_open()) return;
+
+    file_.write(records.data(), records.size());
+    file_.flush();
+}
+
+void DifficultyDatabase::writePendingRecords() {
+    std::string batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch.swap(pendingRecords_);
+    }
+    writeRecords(batch);
+}
+
+std::string DifficultyDatabase::encodeRecord(const Key& key, const FinalResult& result) {
+    const StrainCurve& curve = result.strain;
+    std::string record;
+    record.reserve(RECORD_SIZE + CURVE_HEADER_SIZE + 2 * curve.size());
+    writeLittleEndian<uint64_t>(record, key.chartHash);
+    writeLittleEndian<int32_t>(record, key.rate);
+    writeLittleEndian<int32_t>(record, result.keyCount);
+
+    FinalResult copy = result;
+    for (double* field : recordFields(copy)) {
+        writeLittleEndian<double>(record, *field);
+    }
+
+    writeLittleEndian<uint32_t>(record, static_cast<uint32_t>(curve.size()));
+    writeLittleEndian<int32_t>(record, curve.startTime);
+    writeLittleEndian<float>(record, curve.stepMs);
+    writeLittleEndian<float>(record, curve.peak);
+    record.append(curve.rice.begin(), curve.rice.end());
+    record.append(curve.ln.begin(), curve.ln.end());
+    return record;
+}
+
+void DifficultyDatabase::startPrerating(std::vector<const ChartData*> charts, DifficultyCalculator calculator, std::vector<float> rates) {
+    stopPrerating();
+    if (charts.empty() || rates.empty()) return;
+
+    struct PreratingJob {
+        std::vector<const ChartData*> charts;
+        DifficultyCalculator calculator;
+        std::vector<float> rates;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> rated{0};
+    };
+    auto job = std::make_shared<PreratingJob>();
+    job->charts = std::move(charts);
+    job->calculator = std::move(calculator);
+    job->rates = std::move(rates);
+
+    int workerCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    stopRequested_ = false;
+    activeWorkers_ = workerCount;
+
+    for (int i = 0; i < workerCount; ++i) {
+        workers_.emplace_back([this, job]() {
+            SDL_SetCurrentThreadPriority(SDL_THREAD_PRIORITY_LOW);
+
+            std::vector<float> missing;
+            for (size_t index = job->next.fetch_add(1); index < job->charts.size() && !stopRequested_; index = job->next.fetch_add(1)) {
+                const ChartData& chart = *job->charts[index];
+
+                missing.clear();
+                for (float rate : job->rates) {
+                    if (!contains(chart.hash, rate)) missing.push_back(rate);
+                }
+                if (missing.empty()) continue;
+
+                for (const FinalResult& result : job->calculator.calculateRates(chart, missing, 1)) {
+                    insert(chart, result);
+                }
+                job->rated++;
+            }
+
+            if (--activeWorkers_ == 0 && !stopRequested_ && job->rated > 0) {
+                writePendingRecords();
+                GAME_LOG_INFO("Pre-rated " + std::to_string(job->rated.load()) + " of " + std::to_string(job->charts.size()) + " charts");
+            }
+        });
+    }
+}
+
+void DifficultyDatabase::stopPrerating() {
+    stopRequested_ = true;
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    workers_.clear();
+    activeWorkers_ = 0;
+}
+
+bool DifficultyDatabase::isPrerating() const {
+    return activeWorkers_ > 0;
+}
@@ -0,0 +1,126 @@
+#include <rhythm/DifficultyEditSession.h>
+#include <algorithm>
+#include <functional>
+
+DifficultyEditSession::DifficultyEditSession(DifficultyCalculator calculator, float rate)
+    : calculator_(std::move(calculator)), rate_(rate > 0.0f ? rate : 1.0f) {}
+
+const FinalResult& DifficultyEditSession::load(const ChartData& chart) {
+    keyCount_ = chart.keyCount;
+    timingPoints_ = chart.timingPoints;
+    prepared_ = calculator_.prepareNotes(chart);
+    notes_ = prepared_.notes;
+    calculator_.refreshFeatures(prepared_, notes_, 0, notes_.size(), keyCount_, rate_);
+    lists_ = calculator_.buildNoteLists(notes_);
+
+    windows_ = {};
+    loaded_ = true;
+    if (notes_.empty()) {
+        result_ = calculator_.calculate(chart, rate_);
+        return result_;
+    }
+
+    windows_.starts = calculator_.windowStarts(notes_.front().time, notes_.back().time);
+    windows_.skills.resize(windows_.starts.size());
+    return refresh(chart, 0, windows_.starts.size());
+}
+
+bool DifficultyEditSession::sameTiming(const ChartData& chart) const {
+    return std::equal(timingPoints_.begin(), timingPoints_.end(), chart.timingPoints.begin(), chart.timingPoints.end(),
+        [](const TimingPoint& a, const TimingPoint& b) { return a.time == b.time && a.bpm == b.bpm; });
+}
+
+const FinalResult& DifficultyEditSession::refresh(const ChartData& chart, size_t firstWindow, size_t lastWindow) {
+    calculator_.refreshWindows(chart, lists_, windows_, firstWindow, lastWindow, notes_.back().time, rate_);
+    calculator_.refreshWindowTotals(windows_, firstWindow, lastWindow);
+    result_ = calculator_.aggregate(chart, windows_, notes_.front().time, rate_);
+    return result_;
+}
+
+const FinalResult& DifficultyEditSession::update(const ChartData& chart, float editStartMs, float editEndMs) {
+    if (!loaded_ || chart.keyCount != keyCount_ || !sameTiming(chart) || notes_.empty()) return load(chart);
+    if (editEndMs < editStartMs) std::swap(editStartMs, editEndMs);
+
+    const int startTime = notes_.front().time;
+    const int endTime = notes_.back().time;
+
+    // Swap the edited range of prepared notes for the chart's current ones.
+    const NoteData& noteData = *chart.notes;
+    std::span<const float> newTimes = noteData.times();
+    size_t newBegin = std::lower_bound(newTimes.begin(), newTimes.end(), editStartMs) - newTimes.begin();
+    size_t newEnd = std::upper_bound(newTimes.begin(), newTimes.end(), editEndMs) - newTimes.begin();
+    size_t oldBegin = std::lower_bound(prepared_.times.begin(), prepared_.times.end(), editStartMs) - prepared_.times.begin();
+    size_t oldEnd = std::upper_bound(prepared_.times.begin(), prepared_.times.end(), editEndMs) - prepared_.times.begin();
+
+    DifficultyCalculator::PreparedNotes edited;
+    calculator_.prepareRange(noteData, newBegin, newEnd, keyCount_, edited);
+
+    prepared_.times.erase(prepared_.times.begin() + oldBegin, prepared_.times.begin() + oldEnd);
+    prepared_.times.insert(prepared_.times.begin() + oldBegin, edited.times.begin(), edited.times.end());
+    prepared_.notes.erase(prepared_.notes.begin() + oldBegin, prepared_.notes.begin() + oldEnd);
+    prepared_.notes.insert(prepared_.notes.begin() + oldBegin, edited.notes.begin(), edited.notes.end());
+    notes_.erase(notes_.begin() + oldBegin, notes_.begin() + oldEnd);
+    notes_.insert(notes_.begin() + oldBegin, edited.notes.begin(), edited.notes.end());
+
+    if (notes_.empty()) return load(chart);
+
+    // Features look back at the previous note and the previous note in the
+    // same column, and chords group notes by scaled time. So the redone
+    // range starts at the chord run before the edit and runs until the next
+    // note and the next note in every column have been redone.
+    auto scaledTime = [&](size_t i) { return static_cast<int>(prepared_.times[i] / rate_); };
+    const size_t count = notes_.size();
+    size_t begin = std::min(oldBegin, count);
+    while (begin > 0 && begin < count && scaledTime(begin - 1) == scaledTime(begin)) begin--;
+
+    size_t end = oldBegin + edited.notes.size();
+    std::vector<bool> columnSeen(static_cast<size_t>(std::max(keyCount_, 0)), false);
+    size_t columnsSeen = 0;
+    bool nextSeen = false;
+    while (end < count && (!nextSeen || columnsSeen < columnSeen.size())) {
+        const CalculatedNote& note = prepared_.notes[end++];
+        if (note.type == HOLD_END) continue;
+        nextSeen = true;
+        size_t column = static_cast<size_t>(note.column);
+        if (column < columnSeen.size() && !columnSeen[column]) {
+            columnSeen[column] = true;
+            columnsSeen++;
+        }
+    }
+    while (end > 0 && end < count && scaledTime(end) == scaledTime(end - 1)) end++;
+
+    calculator_.refreshFeatures(prepared_, notes_, begin, end, keyCount_, rate_);
+
+    // Moving either end of the chart moves every window.
+    if (notes_.front().time != startTime || notes_.back().time != endTime) return load(chart);
+
+    // The splice may have moved notes_, so every list is rebuilt. The rice
+    // lists before and after the redone range are unchanged, which tells how
+    // many old terms the redone range replaces.
+    size_t oldRiceCount = lists_.rice.size();
+    calculator_.collectNotes(notes_, lists_);
+    if (calculator_.getKernels() == DifficultyKernels::FAST) {
+        auto riceIndex = [&](size_t noteIndex) {
+            const CalculatedNote* note = notes_.data() + noteIndex;
+            return static_cast<size_t>(std::lower_bound(lists_.rice.begin(), lists_.rice.end(), note, std::less<const CalculatedNote*>()) - lists_.rice.begin());
+        };
+        size_t riceBegin = riceIndex(begin);
+        size_t riceEnd = riceIndex(end);
+        size_t unchangedAfter = lists_.rice.size() - riceEnd;
+        calculator_.refreshRiceTerms(lists_.rice, lists_.riceTerms, riceBegin, oldRiceCount - unchangedAfter - riceBegin, riceEnd - riceBegin);
+    }
+
+    int changedFrom = static_cast<int>(editStartMs / rate_);
+    int changedTo = static_cast<int>(editEndMs / rate_);
+    if (begin < end) {
+        changedFrom = std::min(changedFrom, notes_[begin].time);
+        changedTo = std::max(changedTo, notes_[end - 1].time);
+    }
+
+    const DifficultyConfig& config = calculator_.getConfig();
+    const std::vector<double>& starts = windows_.starts;
+    size_t firstWindow = std::upper_bound(starts.begin(), starts.end(), changedFrom - config.WINDOW_MS) - starts.begin();
+    size_t lastWindow = std::upper_bound(starts.begin(), starts.end(), (double)changedTo) - starts.begin();
+
+    return refresh(chart, firstWindow, lastWindow);
+}
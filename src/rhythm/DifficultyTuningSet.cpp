@@ -0,0 +1,35 @@
+#include <rhythm/DifficultyTuningSet.h>
+
+DifficultyTuningSet::DifficultyTuningSet(DifficultyKernels kernels) : kernels_(kernels) {}
+
+bool DifficultyTuningSet::add(const ChartData& chart, float rate, double target) {
+    if (!chart.notes || chart.notes->empty()) return false;
+
+    Sample sample;
+    sample.chart = chart;
+    sample.rate = rate > 0.0f ? rate : 1.0f;
+    sample.target = target;
+    samples_.push_back(std::move(sample));
+    return true;
+}
+
+void DifficultyTuningSet::prepare(size_t index) {
+    Sample& sample = samples_[index];
+    DifficultyCalculator calculator;
+    sample.features = calculator.processNotes(sample.chart, sample.rate);
+    sample.hasWindows = false;
+}
+
+double DifficultyTuningSet::rate(size_t index, const DifficultyConfig& config) {
+    Sample& sample = samples_[index];
+    if (sample.features.empty()) return 0.0;
+
+    DifficultyCalculator calculator(config);
+    calculator.setKernels(kernels_);
+    if (!sample.hasWindows || !DifficultyCalculator::sameWindowSettings(sample.windowConfig, config)) {
+        sample.windows = calculator.rateWindows(sample.chart, sample.features, sample.rate);
+        sample.windowConfig = config;
+        sample.hasWindows = true;
+    }
+    return calculator.aggregate(sample.chart, sample.windows, sample.features.front().time, sample.rate).rawDiff;
+}
@@ -0,0 +1,123 @@
+#include <rhythm/DifficultyWorker.h>
+#include <algorithm>
+
+DifficultyWorker::~DifficultyWorker() {
+    stop();
+}
+
+void DifficultyWorker::start(DifficultyDatabase& database, const DifficultyCalculator& calculator) {
+    stop();
+
+    database_ = &database;
+    calculator_ = calculator;
+    running_ = true;
+    thread_ = std::thread(&DifficultyWorker::run, this);
+}
+
+void DifficultyWorker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+
+    cancelQueued();
+    database_ = nullptr;
+}
+
+DifficultyWorker::Results DifficultyWorker::submit(const ChartData& chart, std::vector<float> rates, bool speculative) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto sameRequest = [&](const std::shared_ptr<Job>& job) {
+        return job && job->chart->hash == chart.hash && job->rates == rates;
+    };
+
+    if (sameRequest(current_)) return current_->future;
+
+    auto queued = std::find_if(queue_.begin(), queue_.end(), sameRequest);
+    if (queued != queue_.end()) {
+        std::shared_ptr<Job> job = *queued;
+        if (job->speculative && !speculative) {
+            job->speculative = false;
+            queue_.erase(queued);
+            queue_.push_front(job);
+        }
+        return job->future;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->chart = &chart;
+    job->rates = std::move(rates);
+    job->speculative = speculative;
+    job->future = job->promise.get_future().share();
+
+    if (!running_) {
+        job->promise.set_value({});
+        return job->future;
+    }
+
+    if (speculative) {
+        queue_.push_back(job);
+    } else {
+        // Ahead of speculative work, behind earlier interactive requests.
+        auto firstSpeculative = std::find_if(queue_.begin(), queue_.end(), [](const auto& queuedJob) { return queuedJob->speculative; });
+        queue_.insert(firstSpeculative, job);
+    }
+    cv_.notify_one();
+    return job->future;
+}
+
+void DifficultyWorker::cancelQueued() {
+    std::deque<std::shared_ptr<Job>> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled.swap(queue_);
+    }
+    for (auto& job : cancelled) {
+        job->promise.set_value({});
+    }
+}
+
+void DifficultyWorker::run() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return !queue_.empty() || !running_; });
+            if (!running_) return;
+
+            current_ = queue_.front();
+            queue_.pop_front();
+        }
+
+        process(*current_);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        current_.reset();
+    }
+}
+
+void DifficultyWorker::process(Job& job) {
+    std::vector<float> missing;
+    for (float rate : job.rates) {
+        if (!database_->contains(job.chart->hash, rate)) missing.push_back(rate);
+    }
+
+    // Speculative work stays on this thread so it never competes with the
+    // chart on screen for every core.
+    if (!missing.empty()) {
+        for (const FinalResult& result : calculator_.calculateRates(*job.chart, missing, job.speculative ? 1 : 0)) {
+            database_->insert(*job.chart, result);
+        }
+    }
+
+    std::vector<FinalResult> results;
+    results.reserve(job.rates.size());
+    for (float rate : job.rates) {
+        if (std::optional<FinalResult> result = database_->find(*job.chart, rate)) {
+            results.push_back(*result);
+        }
+    }
+    job.promise.set_value(std::move(results));
+}
@@ -143,7 +143,7 @@ void Playfield::init(AppContext *appContext, int keyCount, float height, SkinUti
     offsetDistribution_ = std::uniform_real_distribution<float>(-0.002f, 0.002f);
 }
 
-void Playfield::loadNotes(ChartData *chartData)
+void Playfield::loadNotes(const ChartData *chartData)
 {
     Note tempNote(0, 0, 0, 0);
     tempNote.loadTextures(renderer_, this);
@@ -151,68 +151,67 @@ void Playfield::loadNotes(ChartData *chartData)
     HoldNote tempHoldNote(0, 0, 0, 0);
     tempHoldNote.loadTextures(renderer_, this);
 
-    std::map<int, HoldNote*> openHoldNotes;
+    scrollVelocityMap_ = ScrollVelocityMap(chartData->scrollVelocities);
+    scrollVelocityCursor_ = 0;
+    size_t loadCursor = 0;
 
-    std::sort(chartData->notes.begin(), chartData->notes.end(),
-        [](const NoteStruct &a, const NoteStruct &b)
-        {
-            if (a.time != b.time)
-            {
-                return a.time < b.time;
-            }
+    // Charts are normalized by ChartValidator on import; only a key count
+    // mismatch with this playfield can still leave notes out.
+    const NoteData &noteData = *chartData->notes;
+    notes_.reserve(notes_.size() + noteData.size());
+    int skippedNotes = 0;
 
-            return a.type < b.type;
-        });
-
-    for (const auto &noteStruct : chartData->notes)
+    for (size_t i = 0; i < noteData.size(); ++i)
     {
-        if (noteStruct.column < 0 || noteStruct.column >= keyCount_)
+        int column = noteData.getColumn(i);
+        NoteType type = noteData.getType(i);
+        float time = noteData.getTime(i);
+
+        if (column < 0 || column >= keyCount_)
         {
-            GAME_LOG_WARN("Note column " + std::to_string(noteStruct.column) + " is out of bounds for key count " + std::to_string(keyCount_) + ". Skipping note.");
+            skippedNotes++;
             continue;
         }
 
         Note *note = nullptr;
-        float strumX = getStrumXPosition(noteStruct.column, keyCount_, playfieldWidth_);
+        float strumX = getStrumXPosition(column, keyCount_, playfieldWidth_);
 
-        if (noteStruct.type == HOLD_START)
+        if (type == HOLD_START)
         {
-            note = new HoldNote(strumX, -keySize_, keySize_, keySize_, noteStruct.column);
-            openHoldNotes[noteStruct.column] = static_cast<HoldNote*>(note);
-        }
-        else if (noteStruct.type == HOLD_END)
-        {
-            auto it = openHoldNotes.find(noteStruct.column);
-            
-            if (it != openHoldNotes.end()) {
-                HoldNote* holdStartNote = it->second;
-                holdStartNote->setEndTime(noteStruct.time);
+            HoldNote *holdNote = new HoldNote(strumX, -keySize_, keySize_, keySize_, column);
 
-                openHoldNotes.erase(it); 
-                continue; 
-            } else {
-                GAME_LOG_WARN("No matching HOLD_START found for HOLD_END at time " + std::to_string(noteStruct.time) + "ms in column " + std::to_string(noteStruct.column) + ". Skipping HOLD_END data.");
-                continue;
+            int endIndex = noteData.getPairedIndex(i);
+            if (endIndex >= 0)
+            {
+                float endTime = noteData.getTime(endIndex);
+                holdNote->setEndTime(endTime);
+                holdNote->setEndVisualTime(scrollVelocityMap_.getPositionAt(endTime));
             }
+            note = holdNote;
         }
-        else
+        else if (type == HOLD_END)
         {
-            note = new Note(strumX, -keySize_, keySize_, keySize_, noteStruct.column);
+            continue;
         }
-
-        if (!note)
+        else
         {
-            continue;
+            note = new Note(strumX, -keySize_, keySize_, keySize_, column);
         }
 
-        note->setTime(noteStruct.time);
-        note->setType(noteStruct.type);
-        note->setColumn(noteStruct.column);
+        note->setTime(time);
+        note->setVisualTime(scrollVelocityMap_.getPositionAt(time, loadCursor));
+        note->setType(type);
+        note->setColumn(column);
         note->setSpeedModifier(1.0f);
         note->setPlayfield(this);
 
         notes_.push_back(note);
     }
+
+    if (skippedNotes > 0)
+    {
+        GAME_LOG_WARN("Playfield: Skipped " + std::to_string(skippedNotes) + " notes outside " + std::to_string(keyCount_) + " columns.");
+    }
 }
 
 void Playfield::setPosition(float x, float y)
@@ -437,6 +436,8 @@ void Playfield::update(float deltaTime)
         }
     }
 
+    visualPosition_ = scrollVelocityMap_.getPositionAt(currentTime * 1000.0, scrollVelocityCursor_);
+
     int notesToUpdate = std::min(static_cast<int>(notes_.size()), getRenderLimit());
     for (int i = 0; i < notesToUpdate; ++i)
     {
@@ -40,7 +40,7 @@ void PlayState::init(AppContext *appContext, void *payload)
     judgementSystem_ = std::make_unique<JudgementSystem>();
     judgementSystem_->reset();
 
-    if (!conductor_->initialize(chartData_.timingPoints, audioPath_, playbackRate_, 0.0f, -(transitionTime + START_DELAY)))
+    if (!conductor_->initialize(chartData_.timing, audioPath_, playbackRate_, 0.0f, -(transitionTime + START_DELAY)))
     {
         GAME_LOG_ERROR("PlayState: Failed to initialize conductor");
         return;
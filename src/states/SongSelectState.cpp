@@ -4,6 +4,7 @@
 #include <utils/Utils.h>
 #include "system/Logger.h"
 #include <system/AudioManager.h>
+#include <utils/rhythm/OsuUtils.h>
 #include <objects/TextObject.h>
 #include <SDL3/SDL.h>
 #include <iostream>
@@ -13,6 +14,7 @@
 #include <rhythm/Conductor.h> 
 #include <filesystem>
 #include <algorithm>
+#include <chrono>
 
 static const float TITLE_X_POS = 16.0f;
 static const float SCROLL_SPEED_PX_S = 200.0f;
@@ -51,47 +53,60 @@ void SongSelectState::loadAndCrossfadeBackground(const ChartData& chartData)
     this->isFadingOut_ = (newTexture == nullptr && this->currentBackgroundTexture_ != nullptr);
     this->nextBackgroundTexture_ = newTexture;
 }
+
 std::string SongSelectState::getChartTitle(const ChartData& chartData) {
-    auto it = chartData.metadata.find("title");
-    if (it != chartData.metadata.end()) {
-        return it->second;
+    if (!chartData.metadata.title.empty()) {
+        return chartData.metadata.title;
     }
     return "Unknown Title";
 }
 
-SongEntry SongSelectState::loadSongEntry(const std::string& songDirectory, const std::vector<std::string>& chartFiles) 
+// osu!.db is read on a background thread from startup. Its pack joins the
+// library once, from init() or, if the read finishes later, from update().
+bool SongSelectState::addOsuPack()
 {
-    SongEntry song;
-    song.folderPath = songDirectory;
+    OsuUtils* osuUtils = this->appContext ? this->appContext->osuUtils : nullptr;
+    if (this->osuPackAdded_ || !osuUtils || !osuUtils->isParsingFinished()) return false;
+    this->osuPackAdded_ = true;
 
-    for (const auto& chartFile : chartFiles)
-    {
-        std::string fileContent = Utils::readFile(chartFile);
-        
-        std::map<std::string, ChartData> chartsFromFile = ChartUtils::parseChartMultiple(songDirectory, chartFile, fileContent);
-        
-        for (auto& [difficultyName, chartData] : chartsFromFile)
-        {
-            chartData.filePath = songDirectory;
-            chartData.filename = chartFile;
-
-            if (song.difficulties.empty()) {
-                auto itTitle = chartData.metadata.find("title");
-                auto itArtist = chartData.metadata.find("artist");
-                song.title = (itTitle != chartData.metadata.end() ? itTitle->second : "Unknown Title");
-                song.artist = (itArtist != chartData.metadata.end() ? itArtist->second : "Unknown Artist");
-            }
-            
-            song.difficulties[difficultyName] = chartData;
-        }
-    }
-    
-    return song;
+    SongPack pack = SongLibrary::buildOsuPack(osuUtils->getBeatmaps(), osuUtils->getSongsDirectory());
+    if (pack.songs.empty()) return false;
+
+    GAME_LOG_INFO("Added " + std::to_string(pack.songs.size()) + " songs from osu!.db");
+    this->songPacks_.push_back(std::move(pack));
+    this->searchIndex_.build(this->songPacks_);
+    return true;
+}
+
+// Parses a deferred chart and refreshes its search entry, which was built
+// from the osu!.db listing.
+bool SongSelectState::loadChart(ChartData& chart)
+{
+    if (!chart.deferred) return true;
+    if (!SongLibrary::loadChart(chart)) return false;
+
+    this->searchIndex_.updateChart(chart);
+    return true;
 }
 
 void SongSelectState::buildFlatSongList()
 {
     this->flatSongList_.clear();
+
+    // While searching, every pack with a hit is shown expanded with only its
+    // matching songs.
+    if (this->searchActive_) {
+        int lastPackIndex = -1;
+        for (const SongSearchMatch& match : this->searchMatches_) {
+            if (match.packIndex != lastPackIndex) {
+                this->flatSongList_.push_back({true, match.packIndex, -1, this->songPacks_[match.packIndex].name});
+                lastPackIndex = match.packIndex;
+            }
+            const SongEntry& song = this->songPacks_[match.packIndex].songs[match.songIndex];
+            this->flatSongList_.push_back({false, match.packIndex, match.songIndex, song.title});
+        }
+        return;
+    }
     
     for (size_t packIdx = 0; packIdx < this->songPacks_.size(); ++packIdx) {
         const SongPack& pack = this->songPacks_[packIdx];
@@ -125,6 +140,82 @@ void SongSelectState::buildFlatSongList()
     }
 }
 
+void SongSelectState::applySearch()
+{
+    SongSearchQuery query = SongSearchIndex::parseQuery(this->searchText_, this->selectedRate);
+    this->searchActive_ = !query.empty();
+
+    if (this->searchActive_) {
+        this->searchMatches_ = this->searchIndex_.search(query, [this](const ChartData& chart, float rate) {
+            return this->difficultyDb_.findRawDiff(chart.hash, rate).value_or(-1.0);
+        });
+    } else {
+        this->searchMatches_.clear();
+    }
+
+    if (this->searchTextObject_) {
+        this->searchTextObject_->setText(this->searchText_.empty() ? "" 
+            : "Search: " + this->searchText_ + " (" + std::to_string(this->searchMatches_.size()) + ")");
+    }
+
+    this->buildFlatSongList();
+    this->updateChartTitleList();
+    this->resetSelectionIndices();
+    this->lastInputTime_ = SDL_GetTicks();
+
+    if (this->flatSongList_.empty()) {
+        if (this->chartInfoText_) this->chartInfoText_->setText("No matches");
+        if (this->diffTextObject_) this->diffTextObject_->setText("");
+        return;
+    }
+    this->updateSelectedChartInfo(false);
+}
+
+bool SongSelectState::handleSearchInput(const SDL_Event& event)
+{
+    if (event.type == SDL_EVENT_TEXT_INPUT) {
+        std::string text = event.text.text;
+
+        // Until something is typed, -, = and + keep working as rate keys.
+        if (this->searchText_.empty() && text.find_first_not_of("-=+ ") == std::string::npos) {
+            return true;
+        }
+
+        this->searchText_ += text;
+        this->applySearch();
+        return true;
+    }
+
+    if (event.type != SDL_EVENT_KEY_DOWN || this->searchText_.empty()) {
+        return false;
+    }
+
+    switch (event.key.key) {
+        case SDLK_BACKSPACE:
+            while (!this->searchText_.empty() && (static_cast<unsigned char>(this->searchText_.back()) & 0xC0) == 0x80) {
+                this->searchText_.pop_back();
+            }
+            if (!this->searchText_.empty()) {
+                this->searchText_.pop_back();
+            }
+            this->applySearch();
+            return true;
+
+        case SDLK_ESCAPE:
+            this->searchText_.clear();
+            this->applySearch();
+            return true;
+
+        case SDLK_MINUS:
+        case SDLK_KP_MINUS:
+        case SDLK_EQUALS:
+        case SDLK_PLUS:
+        case SDLK_KP_PLUS:
+            return true;
+    }
+    return false;
+}
+
 void SongSelectState::updateChartTitleList()
 {
     for (TextObject *title : this->chartTitles_)
@@ -166,49 +257,19 @@ void SongSelectState::init(AppContext* appContext, void* payload)
     this->listCenterY_ = screenHeight_ / 2.0f;
     this->conductor_ = appContext->conductor;
 
-    std::vector<std::string> topLevelFolders = Utils::getChartList();
-    SongPack miscellaneousPack;
-    miscellaneousPack.name = "Miscellaneous";
-
-    for (const auto& folderPath : topLevelFolders)
-    {
-        std::vector<std::string> chartFiles = Utils::getChartFiles(folderPath);
-
-        if (!chartFiles.empty()) {
-            SongEntry song = loadSongEntry(folderPath, chartFiles);
-            miscellaneousPack.songs.push_back(song);
-        } else {
-            SongPack newPack;
-            newPack.name = std::filesystem::path(folderPath).filename().string();
-            
-            for (const auto &subEntry : std::filesystem::directory_iterator(folderPath))
-            {
-                if (subEntry.is_directory())
-                {
-                    std::string songFolderPath = subEntry.path().string();
-                    std::vector<std::string> songChartFiles = Utils::getChartFiles(songFolderPath);
-                    
-                    if (!songChartFiles.empty()) {
-                        SongEntry song = loadSongEntry(songFolderPath, songChartFiles);
-                        newPack.songs.push_back(song);
-                    }
-                }
-            }
-            
-            if (!newPack.songs.empty()) {
-                this->songPacks_.push_back(newPack);
-            }
-        }
-    }
-    
-    if (!miscellaneousPack.songs.empty()) {
-        this->songPacks_.push_back(miscellaneousPack);
-    }
+    this->songPacks_ = SongLibrary::build();
+    this->addOsuPack();
     
     if (this->songPacks_.empty()) {
         GAME_LOG_ERROR("No charts or packs loaded.");
         return;
     }
+
+    this->searchIndex_.build(this->songPacks_);
+    this->calculator.setKernels(DifficultyKernels::FAST);
+    this->calculator.setStrainCurves(true);
+    this->difficultyDb_.open(DIFFICULTY_DB_PATH, this->calculator);
+    this->difficultyWorker_.start(this->difficultyDb_, this->calculator);
     
     this->buildFlatSongList();
     this->resetSelectionIndices();
@@ -227,6 +288,18 @@ void SongSelectState::init(AppContext* appContext, void* payload)
     this->chartInfoText_->setPosition(listCenterX_, 16.0f);
     this->chartInfoText_->setColor({255, 255, 255, 255});
 
+    this->searchTextObject_ = new TextObject(renderer, MAIN_FONT_PATH, 16);
+    this->searchTextObject_->setAlignment(TEXT_ALIGN_RIGHT);
+    this->searchTextObject_->setXAlignment(ALIGN_RIGHT);
+    this->searchTextObject_->setYAlignment(ALIGN_TOP);
+    this->searchTextObject_->setPosition(screenWidth_ - 16.0f, 16.0f);
+    this->searchTextObject_->setColor({255, 255, 0, 255});
+
+    this->strainGraph_ = new StrainGraph(renderer);
+    this->strainGraph_->setRect({16.0f, screenHeight_ - 16.0f - STRAIN_GRAPH_HEIGHT, STRAIN_GRAPH_WIDTH, STRAIN_GRAPH_HEIGHT});
+
+    SDL_StartTextInput(appContext->window);
+
     conductor_->setOnBPMChangeCallback([this](float newBPM) {
         this->updateSelectedChartInfo(false);
     });
@@ -272,6 +345,20 @@ void SongSelectState::init(AppContext* appContext, void* payload)
 
     this->updateSelectedChartInfo();
     this->updateChartPositions();
+
+    // Rate the rest of the library in the background at 1.0x and the current
+    // rate so search filters and the panel rarely have to wait.
+    std::vector<const ChartData*> charts;
+    for (const auto& pack : this->songPacks_) {
+        for (const auto& song : pack.songs) {
+            for (const auto& [difficultyName, chart] : song.difficulties) {
+                if (!chart.deferred) charts.push_back(&chart);
+            }
+        }
+    }
+    std::vector<float> rates = {1.0f};
+    if (DifficultyDatabase::rateKey(this->selectedRate) != 100) rates.push_back(this->selectedRate);
+    this->difficultyDb_.startPrerating(std::move(charts), this->calculator, std::move(rates));
 }
 
 ChartData& SongSelectState::getCurrentSelectedChart()
@@ -317,7 +404,7 @@ void SongSelectState::playChartPreview(const ChartData& chartData)
     conductor_->setLoopFadeOutDuration(2.0f);
     conductor_->setLoopPauseDuration(1.5f); 
 
-    if (!conductor_->initialize(chartData.timingPoints, audioPath, playbackRate, CROSSFADE_DURATION, previewTime)) {
+    if (!conductor_->initialize(chartData.timing, audioPath, playbackRate, CROSSFADE_DURATION, previewTime)) {
         GAME_LOG_ERROR("Failed to initialize conductor for preview");
         return;
     }
@@ -341,6 +428,14 @@ void SongSelectState::updateSelectedChartInfo(bool playPreview)
     }
 
     ChartData& selectedChart = this->getCurrentSelectedChart();
+    if (!this->loadChart(selectedChart)) {
+        this->chartInfoText_->setText("Could not load " + std::filesystem::path(selectedChart.filename).filename().string());
+        if (this->diffTextObject_) this->diffTextObject_->setText("");
+        if (conductor_) conductor_->stop();
+
+        this->loadAndCrossfadeBackground(ChartData());
+        return;
+    }
     this->updateDifficultyDisplay(selectedChart);
     
     if (playPreview) {
@@ -393,19 +488,77 @@ void updateDifficultyText(TextObject* textObject, const FinalResult& result)
     textObject->setText(ss.str());
 }
 
+void SongSelectState::showDifficulty(const FinalResult& result)
+{
+    updateDifficultyText(this->diffTextObject_, result);
+    if (this->strainGraph_) this->strainGraph_->setCurve(result.strain);
+}
+
+// The whole ladder is rated at once so stepping through rates afterwards
+// only reads the database.
+std::vector<float> SongSelectState::getDifficultyRates() const
+{
+    std::vector<float> rates = DifficultyCalculator::rateLadder(RATE_LADDER_MIN, RATE_LADDER_MAX, RATE_STEP);
+    int selectedKey = DifficultyDatabase::rateKey(this->selectedRate);
+    bool inLadder = std::any_of(rates.begin(), rates.end(), [&](float rate) { return DifficultyDatabase::rateKey(rate) == selectedKey; });
+    if (!inLadder) rates.push_back(this->selectedRate);
+    return rates;
+}
+
 void SongSelectState::updateDifficultyDisplay(ChartData& chartData)
 {
-    FinalResult result;
-    const std::string& key = chartData.filename + "@" + std::to_string(this->selectedRate);
+    // Anything still queued was for the previous selection.
+    this->difficultyWorker_.cancelQueued();
+    this->pendingDifficulty_ = {};
 
-    if (this->difficultyCache_.count(key)) {
-        result = this->difficultyCache_[key];
+    if (std::optional<FinalResult> result = this->difficultyDb_.find(chartData, this->selectedRate)) {
+        this->showDifficulty(*result);
     } else {
-        result = this->calculator.calculate(chartData, this->selectedRate);
-        this->difficultyCache_[key] = result;
+        this->pendingDifficulty_ = this->difficultyWorker_.submit(chartData, this->getDifficultyRates());
+        this->pendingDifficultyHash_ = chartData.hash;
+        if (this->diffTextObject_) this->diffTextObject_->setText("Calculating difficulty...");
+        if (this->strainGraph_) this->strainGraph_->clear();
     }
 
-    updateDifficultyText(this->diffTextObject_, result);
+    this->prerateNeighbours();
+}
+
+void SongSelectState::checkPendingDifficulty()
+{
+    if (!this->pendingDifficulty_.valid()) return;
+    if (this->pendingDifficulty_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+    this->pendingDifficulty_ = {};
+
+    if (this->flatSongList_.empty() || this->flatSongList_[this->selectedIndex_].isPackHeader) return;
+
+    // A result for a chart that is no longer selected is already stored; it
+    // just isn't shown.
+    ChartData& chartData = this->getCurrentSelectedChart();
+    if (chartData.hash != this->pendingDifficultyHash_) return;
+
+    if (std::optional<FinalResult> result = this->difficultyDb_.find(chartData, this->selectedRate)) {
+        this->showDifficulty(*result);
+    }
+}
+
+// Charts around the selection are the likely next picks, so they get rated
+// at the current rate while the player is still looking at this one.
+void SongSelectState::prerateNeighbours()
+{
+    for (int offset = -NEIGHBOUR_PRERATE_RANGE; offset <= NEIGHBOUR_PRERATE_RANGE; ++offset) {
+        int index = this->selectedIndex_ + offset;
+        if (index < 0 || index >= static_cast<int>(this->flatSongList_.size())) continue;
+
+        const FlatSongEntry& entry = this->flatSongList_[index];
+        if (entry.isPackHeader) continue;
+
+        const SongEntry& song = this->songPacks_[entry.packIndex].songs[entry.songIndex];
+        for (const auto& [difficultyName, chart] : song.difficulties) {
+            if (!chart.deferred && !this->difficultyDb_.contains(chart.hash, this->selectedRate)) {
+                this->difficultyWorker_.submit(chart, {this->selectedRate}, true);
+            }
+        }
+    }
 }
 
 void SongSelectState::onSelectionChanged()
@@ -483,7 +636,7 @@ void SongSelectState::handleRightInput()
 
 void SongSelectState::handleRateDecrease()
 {
-    this->selectedRate = std::max(0.1f, this->selectedRate - 0.1f);
+    this->selectedRate = std::max(0.1f, this->selectedRate - RATE_STEP);
     
     if (!this->flatSongList_.empty()) {
         const FlatSongEntry& entry = this->flatSongList_[this->selectedIndex_];
@@ -500,7 +653,7 @@ void SongSelectState::handleRateDecrease()
 
 void SongSelectState::handleRateIncrease()
 {
-    this->selectedRate = std::min(5.0f, this->selectedRate + 0.1f);
+    this->selectedRate = std::min(5.0f, this->selectedRate + RATE_STEP);
     
     if (!this->flatSongList_.empty()) {
         const FlatSongEntry& entry = this->flatSongList_[this->selectedIndex_];
@@ -566,6 +719,10 @@ void SongSelectState::handleEnterInput()
     }
     
     ChartData& selectedChart = this->getCurrentSelectedChart();
+    if (!this->loadChart(selectedChart)) {
+        GAME_LOG_ERROR("Could not load " + selectedChart.filename);
+        return;
+    }
     PlayStateData* payload = new PlayStateData();
     payload->chartData = selectedChart;
     payload->songPath = selectedChart.filePath;
@@ -588,6 +745,7 @@ void SongSelectState::handleEnterInput()
 
 void SongSelectState::handleEvent(const SDL_Event& event)
 {
+    if (this->handleSearchInput(event)) return;
     if (this->flatSongList_.empty()) return;
 
     int listSize = this->chartTitles_.size(); 
@@ -638,6 +796,19 @@ void SongSelectState::handleEvent(const SDL_Event& event)
 
 void SongSelectState::update(float deltaTime)
 {
+    this->checkPendingDifficulty();
+
+    // New packs go at the end, so the list only needs rebuilding around the
+    // current selection.
+    if (this->chartInfoText_ && this->addOsuPack()) {
+        if (this->searchActive_) {
+            this->applySearch();
+        } else {
+            this->buildFlatSongList();
+            this->updateChartTitleList();
+        }
+    }
+
     float distance = this->targetYOffset_ - this->listYOffset_;
 
     if (std::abs(distance) < 1.0f) 
@@ -754,10 +925,20 @@ void SongSelectState::render()
         this->chartInfoText_->render();
     }
 
+    if (this->searchTextObject_)
+    {
+        this->searchTextObject_->render();
+    }
+
     if (this->diffTextObject_)
     {
         //this->diffTextObject_->render();
     }
+
+    if (this->strainGraph_)
+    {
+        this->strainGraph_->render();
+    }
 }
 
 void SongSelectState::destroy()
@@ -766,6 +947,13 @@ void SongSelectState::destroy()
         conductor_->stop();
     }
 
+    this->difficultyWorker_.stop();
+    this->difficultyDb_.close();
+
+    if (appContext) {
+        SDL_StopTextInput(appContext->window);
+    }
+
     if (this->currentBackgroundTexture_) {
         SDL_DestroyTexture(this->currentBackgroundTexture_);
         this->currentBackgroundTexture_ = nullptr;
@@ -792,4 +980,16 @@ void SongSelectState::destroy()
         delete this->diffTextObject_;
         this->diffTextObject_ = nullptr;
     }
+
+    if (this->searchTextObject_)
+    {
+        delete this->searchTextObject_;
+        this->searchTextObject_ = nullptr;
+    }
+
+    if (this->strainGraph_)
+    {
+        delete this->strainGraph_;
+        this->strainGraph_ = nullptr;
+    }
 }
\ No newline at end of file
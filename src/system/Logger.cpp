@@ -59,7 +59,7 @@ Logger::Logger() {
 
     std::string logFileName = "game_" + currentDate + "_" + currentTime + ".log";
     logFile_.open(logDirectory + "/" + logFileName, std::ios::out | std::ios::trunc);
-    std::cout << "Log file created at: " << logDirectory + "/" + logFileName << std::endl;
+    std::cerr << "Log file created at: " << logDirectory + "/" + logFileName << std::endl;
 
     if (!logFile_.is_open()) {
         std::cerr << "ERROR: Failed to open log file '" << logFileName << "'. Logging to console only." << std::endl;
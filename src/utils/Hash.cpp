@@ -0,0 +1,138 @@
+#include <utils/Hash.h>
+#include <cstring>
+
+namespace {
+    constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+    inline uint64_t rotl(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    inline uint64_t read64(const uint8_t* ptr) {
+        uint64_t value;
+        std::memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t read32(const uint8_t* ptr) {
+        uint32_t value;
+        std::memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * PRIME64_2;
+        acc = rotl(acc, 31);
+        return acc * PRIME64_1;
+    }
+
+    inline uint64_t mergeRound(uint64_t acc, uint64_t value) {
+        acc ^= round(0, value);
+        return acc * PRIME64_1 + PRIME64_4;
+    }
+}
+
+namespace Hash {
+    Xxh64::Xxh64(uint64_t seed) : seed_(seed) {
+        acc_[0] = seed + PRIME64_1 + PRIME64_2;
+        acc_[1] = seed + PRIME64_2;
+        acc_[2] = seed;
+        acc_[3] = seed - PRIME64_1;
+    }
+
+    void Xxh64::update(const void* data, size_t length) {
+        if (length == 0) return;
+
+        const uint8_t* ptr = static_cast<const uint8_t*>(data);
+        const uint8_t* end = ptr + length;
+        totalLength_ += length;
+
+        if (bufferSize_ + length < sizeof(buffer_)) {
+            std::memcpy(buffer_ + bufferSize_, ptr, length);
+            bufferSize_ += length;
+            return;
+        }
+
+        if (bufferSize_ > 0) {
+            size_t fill = sizeof(buffer_) - bufferSize_;
+            std::memcpy(buffer_ + bufferSize_, ptr, fill);
+            ptr += fill;
+            for (int i = 0; i < 4; ++i) {
+                acc_[i] = round(acc_[i], read64(buffer_ + i * 8));
+            }
+            bufferSize_ = 0;
+        }
+
+        // Four independent lanes per 32-byte stripe; the compiler keeps them
+        // in registers and interleaves the multiplies.
+        while (end - ptr >= 32) {
+            acc_[0] = round(acc_[0], read64(ptr));
+            acc_[1] = round(acc_[1], read64(ptr + 8));
+            acc_[2] = round(acc_[2], read64(ptr + 16));
+            acc_[3] = round(acc_[3], read64(ptr + 24));
+            ptr += 32;
+        }
+
+        bufferSize_ = static_cast<size_t>(end - ptr);
+        std::memcpy(buffer_, ptr, bufferSize_);
+    }
+
+    uint64_t Xxh64::digest() const {
+        uint64_t hash;
+        if (totalLength_ >= 32) {
+            hash = rotl(acc_[0], 1) + rotl(acc_[1], 7) + rotl(acc_[2], 12) + rotl(acc_[3], 18);
+            for (int i = 0; i < 4; ++i) {
+                hash = mergeRound(hash, acc_[i]);
+            }
+        } else {
+            hash = seed_ + PRIME64_5;
+        }
+
+        hash += totalLength_;
+
+        const uint8_t* ptr = buffer_;
+        const uint8_t* end = buffer_ + bufferSize_;
+        while (end - ptr >= 8) {
+            hash ^= round(0, read64(ptr));
+            hash = rotl(hash, 27) * PRIME64_1 + PRIME64_4;
+            ptr += 8;
+        }
+        if (end - ptr >= 4) {
+            hash ^= static_cast<uint64_t>(read32(ptr)) * PRIME64_1;
+            hash = rotl(hash, 23) * PRIME64_2 + PRIME64_3;
+            ptr += 4;
+        }
+        while (ptr < end) {
+            hash ^= (*ptr) * PRIME64_5;
+            hash = rotl(hash, 11) * PRIME64_1;
+            ++ptr;
+        }
+
+        hash ^= hash >> 33;
+        hash *= PRIME64_2;
+        hash ^= hash >> 29;
+        hash *= PRIME64_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    uint64_t xxh64(const void* data, size_t length, uint64_t seed) {
+        Xxh64 hasher(seed);
+        hasher.update(data, length);
+        return hasher.digest();
+    }
+
+    std::string toHex(uint64_t hash) {
+        static const char digits[] = "0123456789abcdef";
+        std::string result(16, '0');
+        for (int i = 15; i >= 0; --i) {
+            result[i] = digits[hash & 0xF];
+            hash >>= 4;
+        }
+        return result;
+    }
+}
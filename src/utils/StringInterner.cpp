@@ -0,0 +1,26 @@
+#include <utils/StringInterner.h>
+
+StringInterner& StringInterner::getInstance() {
+    static StringInterner instance;
+    return instance;
+}
+
+const std::string* StringInterner::emptyString() {
+    static const std::string empty;
+    return &empty;
+}
+
+const std::string* StringInterner::intern(std::string_view value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = strings_.find(value);
+    if (it == strings_.end()) {
+        it = strings_.emplace(value).first;
+    }
+    return &*it;
+}
+
+size_t StringInterner::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return strings_.size();
+}
@@ -12,6 +12,7 @@
 #include <sys/stat.h>
 
 static const std::vector<std::string> supportedChartExtensions = {
+    ".vscb", 
     ".vsc", 
     ".osu", 
     ".sm", 
@@ -93,72 +94,19 @@ namespace Utils
 
     float getAudioStartPos(const ChartData &chartData)
     {
-        auto it = chartData.metadata.find("previewTime");
-        if (it != chartData.metadata.end() && !it->second.empty())
-        {
-            std::string startPosStr = it->second;
-            try
-            {
-                float startPos = std::stof(startPosStr);
-                if (startPos >= 0.0f)
-                {
-                    return startPos;
-                }
-                else
-                {
-                    GAME_LOG_ERROR("Invalid start position in metadata: " + startPosStr);
-                }
-            }
-            catch (const std::invalid_argument &e)
-            {
-                GAME_LOG_ERROR("Invalid start position format: " + std::string(e.what()));
-            }
-            catch (const std::out_of_range &e)
-            {
-                GAME_LOG_ERROR("Start position out of range: " + std::string(e.what()));
-            }
-        }
-
-        return 0.0f;
+        return std::max(chartData.metadata.previewTime, 0.0f);
     }
 
     float getAudioPreviewLength(const ChartData &chartData)
     {
-        auto it = chartData.metadata.find("previewLength");
-        if (it != chartData.metadata.end() && !it->second.empty())
-        {
-            std::string lengthStr = it->second;
-            try
-            {
-                float length = std::stof(lengthStr);
-                if (length > 0.0f)
-                {
-                    return length;
-                }
-                else
-                {
-                    GAME_LOG_ERROR("Invalid preview length in metadata: " + lengthStr);
-                }
-            }
-            catch (const std::invalid_argument &e)
-            {
-                GAME_LOG_ERROR("Invalid preview length format: " + std::string(e.what()));
-            }
-            catch (const std::out_of_range &e)
-            {
-                GAME_LOG_ERROR("Preview length out of range: " + std::string(e.what()));
-            }
-        }
-
-        return -1.0f; 
+        return chartData.metadata.previewLength > 0.0f ? chartData.metadata.previewLength : -1.0f;
     }
 
     std::string getAudioPath(const ChartData &chartData)
     {
-        auto it = chartData.metadata.find("audio");
-        if (it != chartData.metadata.end() && !it->second.empty())
+        if (!chartData.metadata.audio.empty())
         {
-            std::string audioPath = it->second;
+            std::string audioPath = chartData.metadata.audio;
 
             if (audioPath[0] != '/' && audioPath.find("assets/") != 0)
             {
@@ -199,9 +147,8 @@ namespace Utils
         return assetName;
     }
 
-    std::vector<std::string> getChartList()
+    std::vector<std::string> getChartList(const std::string &directoryPath)
     {
-        const std::string &directoryPath = "assets/songs/";
         std::vector<std::string> packDirectories;
 
         if (!std::filesystem::exists(directoryPath) || !std::filesystem::is_directory(directoryPath))
@@ -227,7 +174,7 @@ namespace Utils
             if (entry.is_regular_file())
             {
                 std::string filePath = entry.path().string();
-                if (Utils::hasEnding(filePath, ".vsc"))
+                if (Utils::hasEnding(filePath, ".vsc") || Utils::hasEnding(filePath, ".vscb"))
                 {
                     chartFiles.insert(chartFiles.begin(), filePath);
                     continue;
@@ -269,7 +216,7 @@ namespace Utils
 
     std::string readFile(const std::string &fullPath)
     {
-        std::ifstream t(fullPath);
+        std::ifstream t(fullPath, std::ios::binary);
         if (!t.is_open())
             return "";
 
@@ -1,91 +1,124 @@
 #include <utils/rhythm/ChartUtils.h>
 #include <utils/Utils.h>
+#include <utils/rhythm/TimingMap.h>
+#include <utils/Hash.h>
+#include <utils/rhythm/VscBinary.h>
+#include <utils/rhythm/ChartValidator.h>
+#include <charconv>
 #include <sstream>
 #include <cmath>
 #include <iostream>
-
-std::string ChartUtils::getChartBackgroundName(const ChartData& chartData) {
-    auto it = chartData.metadata.find("background");
-    if (it != chartData.metadata.end()) {
-        return it->second;
+#include <string_view>
+#include <set>
+
+static float parseMetadataSeconds(const std::string& key, const std::string& value) {
+    if (value.empty()) return -1.0f;
+    try {
+        return std::stof(value);
+    } catch (const std::exception& e) {
+        GAME_LOG_ERROR("Invalid " + key + " in metadata: " + value);
     }
-    return "";
+    return -1.0f;
 }
 
-std::string ChartUtils::getChartInfo(const ChartData& chartData, float selectedRate) {
-    std::stringstream ss;
-
-    auto itArtist = chartData.metadata.find("artist");
-    auto itTitle = chartData.metadata.find("title");
-    auto itDifficulty = chartData.metadata.find("difficulty");
-
-    ss << (itArtist != chartData.metadata.end() ? itArtist->second : "Unknown") << " - ";
-    ss << (itTitle != chartData.metadata.end() ? itTitle->second : "Unknown") << "\n[";
-    ss << (itDifficulty != chartData.metadata.end() ? itDifficulty->second : "Unknown") << " " << selectedRate << "x]";
-    
-    return ss.str();
+void ChartMetadata::set(const std::string& key, const std::string& value) {
+    if (key == "title") title = value;
+    else if (key == "artist") artist = value;
+    else if (key == "charter") charter = value;
+    else if (key == "difficulty") difficulty = value;
+    else if (key == "audio") audio = value;
+    else if (key == "background") background = value;
+    else if (key == "mode") mode = value;
+    else if (key == "previewTime") previewTime = parseMetadataSeconds(key, value);
+    else if (key == "previewLength") previewLength = parseMetadataSeconds(key, value);
+    else extra[key] = value;
 }
 
-float calculateBeatsToSeconds(float targetBeat, float offset, const std::vector<TimingPoint> &timingPoints)
-{
-    if (timingPoints.empty())
-    {
-        double initialBPM = 120.0;
-        return (targetBeat * 60.0f / (float)initialBPM) + -offset;
+void ChartMetadata::fillMissing(const ChartMetadata& other) {
+    if (title.empty()) title = other.title;
+    if (artist.empty()) artist = other.artist;
+    if (charter.empty()) charter = other.charter;
+    if (difficulty.empty()) difficulty = other.difficulty;
+    if (audio.empty()) audio = other.audio;
+    if (background.empty()) background = other.background;
+    if (mode.empty()) mode = other.mode;
+    if (previewTime < 0.0f) previewTime = other.previewTime;
+    if (previewLength < 0.0f) previewLength = other.previewLength;
+
+    for (const auto& kv : other.extra) {
+        extra.emplace(kv.first, kv.second);
     }
+}
 
-    float currentTime = 0.0f;
-    float currentBeat = 0.0f;
-    double currentBPM = (timingPoints.front().time == 0.0f) ? timingPoints.front().bpm : 120.0;
-
-    currentTime = -offset;
-
-    if (targetBeat < timingPoints.front().time)
-    {
-        return (targetBeat * 60.0f / (float)currentBPM) + -offset;
+std::vector<std::pair<std::string, std::string>> ChartMetadata::entries() const {
+    std::vector<std::pair<std::string, std::string>> result;
+
+    auto addString = [&](const char* key, const InternedString& value) {
+        if (!value.empty()) result.emplace_back(key, value.str());
+    };
+    auto addSeconds = [&](const char* key, float value) {
+        if (value < 0.0f) return;
+        std::ostringstream oss;
+        oss << value;
+        result.emplace_back(key, oss.str());
+    };
+
+    addString("title", title);
+    addString("artist", artist);
+    addString("charter", charter);
+    addString("difficulty", difficulty);
+    addString("audio", audio);
+    addString("background", background);
+    addString("mode", mode);
+    addSeconds("previewTime", previewTime);
+    addSeconds("previewLength", previewLength);
+
+    for (const auto& kv : extra) {
+        result.emplace_back(kv.first, kv.second);
     }
+    return result;
+}
 
-    for (size_t i = 0; i < timingPoints.size(); ++i)
-    {
-        const TimingPoint &tp = timingPoints[i];
+uint64_t ChartUtils::computeChartHash(const ChartData& chartData) {
+    Hash::Xxh64 hasher;
+    hasher.updateValue(static_cast<int32_t>(chartData.keyCount));
 
-        if (tp.time > currentBeat)
-        {
-            float segmentBeats = tp.time - currentBeat;
-            currentTime += (segmentBeats * 60.0f / (float)currentBPM);
-            currentBeat = tp.time;
-        }
+    const NoteData& notes = *chartData.notes;
+    hasher.updateValue(static_cast<uint64_t>(notes.size()));
+    hasher.update(notes.times());
+    hasher.update(notes.columns());
+    hasher.update(notes.types());
 
-        currentBPM = tp.bpm;
+    for (const auto& tp : chartData.timingPoints) {
+        hasher.updateValue(tp.time);
+        hasher.updateValue(tp.bpm);
+    }
+    for (const auto& sv : chartData.scrollVelocities) {
+        hasher.updateValue(sv.time);
+        hasher.updateValue(sv.multiplier);
+    }
+    return hasher.digest();
+}
 
-        if (i + 1 < timingPoints.size())
-        {
-            const TimingPoint &nextTp = timingPoints[i + 1];
+std::string ChartUtils::getChartBackgroundName(const ChartData& chartData) {
+    return chartData.metadata.background;
+}
 
-            if (targetBeat < nextTp.time)
-            {
-                float remainingBeats = targetBeat - currentBeat;
-                currentTime += (remainingBeats * 60.0f / (float)currentBPM);
-                return currentTime;
-            }
-        }
-        else
-        {
-            float remainingBeats = targetBeat - currentBeat;
-            if (remainingBeats >= 0.0f)
-            {
-                currentTime += (remainingBeats * 60.0f / (float)currentBPM);
-            }
-            return currentTime;
-        }
-    }
+std::string ChartUtils::getChartInfo(const ChartData& chartData, float selectedRate) {
+    std::stringstream ss;
 
-    return currentTime;
+    const ChartMetadata& metadata = chartData.metadata;
+    ss << (metadata.artist.empty() ? "Unknown" : metadata.artist.str()) << " - ";
+    ss << (metadata.title.empty() ? "Unknown" : metadata.title.str()) << "\n[";
+    ss << (metadata.difficulty.empty() ? "Unknown" : metadata.difficulty.str()) << " " << selectedRate << "x]";
+    
+    return ss.str();
 }
 
 ChartData ChartUtils::parseVsc(const std::string &content)
 {
     ChartData data;
+    std::vector<NoteStruct> notes;
 
     std::stringstream ss(content);
     std::string line, currentSection;
@@ -107,7 +140,23 @@ ChartData ChartUtils::parseVsc(const std::string &content)
                 size_t eqPos = line.find('=');
                 if (eqPos != std::string::npos)
                 {
-                    data.metadata[line.substr(0, eqPos)] = line.substr(eqPos + 1);
+                    std::string key = line.substr(0, eqPos);
+                    std::string value = line.substr(eqPos + 1);
+                    if (key == "keys")
+                    {
+                        try
+                        {
+                            data.keyCount = std::stoi(value);
+                        }
+                        catch (...)
+                        {
+                            data.keyCount = 4;
+                        }
+                    }
+                    else
+                    {
+                        data.metadata.set(key, value);
+                    }
                 }
             }
             else if (currentSection == "TIMING")
@@ -115,10 +164,12 @@ ChartData ChartUtils::parseVsc(const std::string &content)
                 std::stringstream lss(line);
                 float time;
                 std::string tag;
-                double bpm;
-                lss >> time >> tag >> bpm;
+                double value;
+                lss >> time >> tag >> value;
                 if (tag == "BPM")
-                    data.timingPoints.push_back({time, bpm});
+                    data.timingPoints.push_back({time, value});
+                else if (tag == "SV")
+                    data.scrollVelocities.push_back({time, value});
             }
             else if (currentSection == "NOTES")
             {
@@ -133,63 +184,91 @@ ChartData ChartUtils::parseVsc(const std::string &content)
                     type = HOLD_START;
                 else if (typeStr == "HOLD_END")
                     type = HOLD_END;
+                else if (typeStr == "MINE")
+                    type = MINE;
 
-                data.notes.push_back({time, col, type});
+                notes.push_back({time, col, type});
             }
         }
     }
 
-    if (data.metadata.count("keys"))
-    {
-        try
-        {
-            data.keyCount = std::stoi(data.metadata["keys"]);
-        }
-        catch (...)
-        {
-            data.keyCount = 4;
-        }
-    }
-
-    std::sort(data.notes.begin(), data.notes.end());
+    data.timing = TimingData::fromTimingPoints(data.timingPoints);
+    data.validation = ChartValidator::validate(data, std::move(notes));
+    data.hash = computeChartHash(data);
     return data;
 }
 
-std::string ChartUtils::saveVsc(const std::string &filename, const ChartData &chartData)
+template <typename T>
+static void appendNumber(std::string &out, T value)
 {
-    std::stringstream ss;
-    ss << "[VSC]\n";
-    for (const auto &kv : chartData.metadata)
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+std::string ChartUtils::serializeVsc(const ChartData &chartData)
+{
+    std::string out;
+    serializeVsc(chartData, out);
+    return out;
+}
+
+// Shortest round-trip float formatting, so a chart saved and reloaded keeps
+// bit-identical times (and therefore the same hash).
+void ChartUtils::serializeVsc(const ChartData &chartData, std::string &out)
+{
+    static constexpr std::string_view noteTypeNames[] = {" TAP\n", " HOLD_START\n", " HOLD_END\n", " MINE\n"};
+
+    const NoteData &notes = *chartData.notes;
+    out.reserve(out.size() + 256 + (chartData.timingPoints.size() + chartData.scrollVelocities.size()) * 24 + notes.size() * 20);
+
+    out += "[VSC]\n";
+    for (const auto &kv : chartData.metadata.entries())
     {
-        ss << kv.first << "=" << kv.second << "\n";
+        out += kv.first;
+        out += '=';
+        out += kv.second;
+        out += '\n';
     }
-    ss << "\n[TIMING]\n";
+    out += "keys=";
+    appendNumber(out, chartData.keyCount);
+    out += "\n\n[TIMING]\n";
     for (const auto &tp : chartData.timingPoints)
     {
-        ss << tp.time << " BPM " << tp.bpm << "\n";
+        appendNumber(out, tp.time);
+        out += " BPM ";
+        appendNumber(out, tp.bpm);
+        out += '\n';
     }
-    ss << "\n[NOTES]\n";
-    for (const auto &note : chartData.notes)
+    for (const auto &sv : chartData.scrollVelocities)
     {
-        std::string typeStr = "TAP";
-        if (note.type == HOLD_START)
-            typeStr = "HOLD_START";
-        else if (note.type == HOLD_END)
-            typeStr = "HOLD_END";
-
-        ss << note.time << " " << note.column << " " << typeStr << "\n";
+        appendNumber(out, sv.time);
+        out += " SV ";
+        appendNumber(out, sv.multiplier);
+        out += '\n';
     }
-    
-    std::string vscContent = ss.str();
+    out += "\n[NOTES]\n";
+    for (size_t i = 0; i < notes.size(); ++i)
+    {
+        appendNumber(out, notes.getTime(i));
+        out += ' ';
+        appendNumber(out, notes.getColumn(i));
+        out += noteTypeNames[notes.getType(i) & 0x3];
+    }
+}
+
+std::string ChartUtils::saveVsc(const std::string &filename, const ChartData &chartData)
+{
+    std::string vscContent = serializeVsc(chartData);
 
     size_t lastDot = filename.find_last_of('.');
     std::string baseFilename = (lastDot == std::string::npos) ? filename : filename.substr(0, lastDot);
     std::string vscFilePath = baseFilename + ".vsc";
 
-    std::ofstream outFile(vscFilePath);
+    std::ofstream outFile(vscFilePath, std::ios::binary);
     if (outFile.is_open())
     {
-        outFile << vscContent;
+        outFile.write(vscContent.data(), vscContent.size());
         outFile.close();
 
         GAME_LOG_DEBUG("ChartManager: Saved VSC file to " + vscFilePath);
@@ -204,6 +283,7 @@ std::string ChartUtils::saveVsc(const std::string &filename, const ChartData &ch
 ChartData ChartUtils::convertOsuToChartData(const std::string &osuContent)
 {
     ChartData data;
+    std::vector<NoteStruct> notes;
     std::stringstream ss(osuContent);
     std::string line;
     std::string section = "";
@@ -230,13 +310,13 @@ ChartData ChartUtils::convertOsuToChartData(const std::string &osuContent)
                 std::transform(key.begin(), key.end(), key.begin(), ::tolower);
 
                 if (key == "title")
-                    data.metadata["title"] = val;
+                    data.metadata.title = val;
                 else if (key == "artist")
-                    data.metadata["artist"] = val;
+                    data.metadata.artist = val;
                 else if (key == "creator")
-                    data.metadata["charter"] = val;
+                    data.metadata.charter = val;
                 else if (key == "version")
-                    data.metadata["difficulty"] = val;
+                    data.metadata.difficulty = val;
             }
         }
         else if (section == "General")
@@ -248,7 +328,7 @@ ChartData ChartUtils::convertOsuToChartData(const std::string &osuContent)
                 std::string val = Utils::trim(trimmedLine.substr(colonPos + 1));
                 if (key == "AudioFilename")
                 {
-                    data.metadata["audio"] = val;
+                    data.metadata.audio = val;
                 }
             }
         }
@@ -264,7 +344,7 @@ ChartData ChartUtils::convertOsuToChartData(const std::string &osuContent)
                     {
                         bgFile = bgFile.substr(1, bgFile.size() - 2);
                     }
-                    data.metadata["background"] = bgFile;
+                    data.metadata.background = bgFile;
                 }
             }
         }
@@ -274,7 +354,6 @@ ChartData ChartUtils::convertOsuToChartData(const std::string &osuContent)
             {
                 size_t colonPos = trimmedLine.find(':');
                 data.keyCount = std::stoi(Utils::trim(trimmedLine.substr(colonPos + 1)));
-                data.metadata["keys"] = std::to_string(data.keyCount);
             }
         }
         else if (section == "TimingPoints")
@@ -288,6 +367,17 @@ ChartData ChartUtils::convertOsuToChartData(const std::string &osuContent)
                 {
                     double bpm = 60000.0 / msPerBeat;
                     data.timingPoints.push_back({time, bpm});
+                    data.scrollVelocities.push_back({time, 1.0});
+                }
+            }
+            else if (parts.size() >= 7)
+            {
+                float time = std::floor(std::stod(parts[0]));
+                double msPerBeat = std::stod(parts[1]);
+                if (msPerBeat < 0)
+                {
+                    double multiplier = std::clamp(-100.0 / msPerBeat, 0.01, 10.0);
+                    data.scrollVelocities.push_back({time, multiplier});
                 }
             }
         }
@@ -314,402 +404,402 @@ ChartData ChartUtils::convertOsuToChartData(const std::string &osuContent)
 
                     if (endTime > time)
                     {
-                        data.notes.push_back({time, column, HOLD_START});
-                        data.notes.push_back({endTime, column, HOLD_END});
+                        notes.push_back({time, column, HOLD_START});
+                        notes.push_back({endTime, column, HOLD_END});
                     }
                 }
                 else
                 {
-                    data.notes.push_back({time, column, TAP});
+                    notes.push_back({time, column, TAP});
                 }
             }
         }
     }
 
-    std::sort(data.notes.begin(), data.notes.end());
+    data.timing = TimingData::fromTimingPoints(data.timingPoints);
+    data.validation = ChartValidator::validate(data, std::move(notes));
+    data.hash = computeChartHash(data);
     return data;
 }
 
-ChartData processSmNotesBlock(const std::string& notesBlock, float offset, const std::vector<TimingPoint>& timingPoints, bool isSSC) {
-    ChartData data;
-    data.timingPoints = timingPoints;
-    
-    std::stringstream chart_ss(notesBlock);
-    
-    if (isSSC) {
-        std::string line;
-        while (std::getline(chart_ss, line)) {
-            line = Utils::trim(line);
-            if (line.empty()) continue;
-            
-            if (line.front() == '#') {
-                if (line.back() == ';') {
-                    line = line.substr(0, line.length() - 1);
-                    line = Utils::trim(line);
-                }
-                
-                size_t colonPos = line.find(':');
-                if (colonPos != std::string::npos) {
-                    std::string tag = line.substr(1, colonPos - 1);
-                    std::string value = line.substr(colonPos + 1);
-                    
-                    tag = Utils::trim(tag);
-                    value = Utils::trim(value);
-                    
-                    if (tag == "STEPSTYPE") {
-                        data.metadata["mode"] = value;
-                        if (value == "dance-single") data.keyCount = 4;
-                        else if (value == "dance-double") data.keyCount = 8;
-                        data.metadata["keys"] = std::to_string(data.keyCount);
-                    } else if (tag == "DESCRIPTION") {
-                        data.metadata["charter"] = value;
-                    } else if (tag == "DIFFICULTY") {
-                        data.metadata["difficulty"] = value;
-                    } else if (tag == "NOTES") {
-                        std::string chartNotesData;
-                        std::string tempLine;
-                        while (std::getline(chart_ss, tempLine)) {
-                            chartNotesData += tempLine + "\n";
-                        }
-                        
-                        std::string chartNotesDataCleaned;
-                        for (char c : chartNotesData) {
-                            if (c == '\r') continue;
-                            chartNotesDataCleaned += c;
-                        }
-                        
-                        size_t npos = chartNotesDataCleaned.find("\n\n");
-                        while (npos != std::string::npos) {
-                            chartNotesDataCleaned.replace(npos, 2, "\n");
-                            npos = chartNotesDataCleaned.find("\n\n");
-                        }
-                        
-                        std::stringstream measure_ss(chartNotesDataCleaned);
-                        std::string measureStr;
-                        int measureIndex = 0;
-                        
-                        while (std::getline(measure_ss, measureStr, ',')) {
-                            measureStr = Utils::trim(measureStr);
-                            
-                            std::stringstream row_ss(measureStr);
-                            std::string rowStr;
-                            std::vector<std::string> rows;
-                            
-                            while (std::getline(row_ss, rowStr, '\n')) {
-                                rowStr = Utils::trim(rowStr);
-                                
-                                bool hasNoteChar = false;
-                                for (char c : rowStr) {
-                                    if (c == '0' || c == '1' || c == '2' || c == '3' || c == '4' || c == 'M') {
-                                        hasNoteChar = true;
-                                        break;
-                                    }
-                                }
-                                
-                                if (!rowStr.empty() && hasNoteChar) {
-                                    rows.push_back(rowStr);
-                                }
-                            }
-                            
-                            int rowsPerMeasure = rows.size();
-                            
-                            if (rowsPerMeasure == 0) {
-                                measureIndex++;
-                                continue;
-                            }
-
-                            float measureLengthBeats = 4.0f; 
-                            
-                            for (int rowIndex = 0; rowIndex < rowsPerMeasure; ++rowIndex) {
-                                const std::string& noteRow = rows[rowIndex];
-                                
-                                float beat = (float)measureIndex * measureLengthBeats + 
-                                             (float)rowIndex * (measureLengthBeats / (float)rowsPerMeasure);
-                                
-                                float time = calculateBeatsToSeconds(beat, offset, data.timingPoints) * 1000.0f;
-                                
-                                for (int col = 0; col < std::min((int)noteRow.length(), data.keyCount); ++col) {
-                                    char noteTypeChar = noteRow[col];
-                                    NoteType noteType = TAP;
-                                    bool isNote = true;
-
-                                    switch (noteTypeChar) {
-                                        case '1': noteType = TAP; break;
-                                        case '2': noteType = HOLD_START; break;
-                                        case '3': noteType = HOLD_END; break;
-                                        case 'M': noteType = MINE; break;
-                                        default: isNote = false; break;
-                                    }
-                                    
-                                    if (isNote) {
-                                        data.notes.push_back({time, col, noteType});
-                                    }
-                                }
-                            }
-
-                            measureIndex++;
-                        }
-                        break;
-                    }
-                }
-            }
+struct SmNote {
+    double beat;
+    int column;
+    NoteType type;
+};
+
+struct SmChartSection {
+    ChartMetadata metadata;
+    int keyCount = 0;
+    std::vector<SmNote> notes;
+
+    // SSC charts may declare their own timing; any tag listed here makes it
+    // replace the song timing as a whole.
+    TimingData timing;
+    std::set<std::string> timingTags;
+};
+
+static bool isSmSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool isSmComment(std::string_view src, size_t pos) {
+    return src[pos] == '/' && pos + 1 < src.size() && src[pos + 1] == '/';
+}
+
+static size_t skipSmLine(std::string_view src, size_t pos) {
+    size_t eol = src.find('\n', pos);
+    return eol == std::string_view::npos ? src.size() : eol + 1;
+}
+
+static std::string_view trimSmView(std::string_view value) {
+    while (!value.empty() && isSmSpace(value.front())) value.remove_prefix(1);
+    while (!value.empty() && isSmSpace(value.back())) value.remove_suffix(1);
+    return value;
+}
+
+static int getSmStepsTypeKeyCount(const std::string& stepsType) {
+    static const std::map<std::string, int> keyCounts = {
+        {"dance-single", 4}, {"dance-double", 8}, {"dance-couple", 8}, {"dance-solo", 6}, {"dance-threepanel", 3},
+        {"pump-single", 5}, {"pump-halfdouble", 6}, {"pump-double", 10}, {"pump-couple", 10},
+        {"kb7-single", 7}, {"para-single", 5},
+        {"techno-single4", 4}, {"techno-single5", 5}, {"techno-single8", 8}, {"techno-double4", 8}, {"techno-double5", 10}
+    };
+
+    auto it = keyCounts.find(stepsType);
+    return it != keyCounts.end() ? it->second : 0;
+}
+
+// Returns the end of a tag value: its terminating ';', or the '#' of the next
+// tag when the ';' was left out. Comments are skipped, so a ';' inside one does
+// not end the value.
+static size_t findSmValueEnd(std::string_view src, size_t pos) {
+    bool lineStart = false;
+    while (pos < src.size()) {
+        char c = src[pos];
+        if (c == ';') return pos;
+        if (c == '#' && lineStart) return pos;
+        if (isSmComment(src, pos)) {
+            pos = skipSmLine(src, pos);
+            lineStart = true;
+            continue;
         }
-    } else {
-        std::vector<std::string> properties;
-        std::string accumulated;
-        
-        int colonCount = 0;
-        char ch;
-        while (chart_ss.get(ch) && colonCount < 5) {
-            if (ch == ':') {
-                properties.push_back(Utils::trim(accumulated));
-                accumulated.clear();
-                colonCount++;
-            } else {
-                accumulated += ch;
+
+        if (c == '\n') lineStart = true;
+        else if (!isSmSpace(c)) lineStart = false;
+        ++pos;
+    }
+    return pos;
+}
+
+static std::string readSmValue(std::string_view raw) {
+    if (raw.find("//") == std::string_view::npos) {
+        return std::string(trimSmView(raw));
+    }
+
+    std::string value;
+    value.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (isSmComment(raw, i)) {
+            i = skipSmLine(raw, i) - 1;
+            value += '\n';
+            continue;
+        }
+        value += raw[i];
+    }
+    return std::string(trimSmView(value));
+}
+
+static void emitSmMeasure(const std::vector<std::string_view>& rows, int measureIndex, SmChartSection& section) {
+    if (rows.empty()) return;
+
+    const double measureLengthBeats = 4.0;
+    double rowLengthBeats = measureLengthBeats / (double)rows.size();
+
+    if (section.keyCount <= 0) {
+        section.keyCount = (int)rows.front().size();
+    }
+
+    for (size_t rowIndex = 0; rowIndex < rows.size(); ++rowIndex) {
+        std::string_view row = rows[rowIndex];
+        double beat = (double)measureIndex * measureLengthBeats + (double)rowIndex * rowLengthBeats;
+
+        int columns = std::min((int)row.size(), section.keyCount);
+        for (int col = 0; col < columns; ++col) {
+            switch (row[col]) {
+                case '1': section.notes.push_back({beat, col, TAP}); break;
+                case '2':
+                case '4': section.notes.push_back({beat, col, HOLD_START}); break;
+                case '3': section.notes.push_back({beat, col, HOLD_END}); break;
+                case 'M': section.notes.push_back({beat, col, MINE}); break;
+                default: break;
             }
         }
+    }
+}
 
-        if (properties.size() >= 5) {
-            data.metadata["mode"] = properties[0];
-            if (properties[0] == "dance-single") data.keyCount = 4;
-            else if (properties[0] == "dance-double") data.keyCount = 8;
-            data.metadata["keys"] = std::to_string(data.keyCount);
-            
-            data.metadata["charter"] = properties[1];
-            data.metadata["difficulty"] = properties[2];
+// Single pass over a #NOTES body: rows are collected as views into the source
+// until the measure ends, then emitted as beats. Returns the position right
+// after the body.
+static size_t parseSmNoteData(std::string_view src, size_t pos, SmChartSection& section, std::vector<std::string_view>& rows) {
+    int measureIndex = 0;
+    bool lineStart = false;
+    rows.clear();
+
+    auto endMeasure = [&]() {
+        emitSmMeasure(rows, measureIndex, section);
+        rows.clear();
+        measureIndex++;
+    };
+
+    while (pos < src.size()) {
+        char c = src[pos];
+
+        if (c == ';') {
+            endMeasure();
+            return pos + 1;
         }
-        
-        std::string chartNotesData;
-        std::string tempLine;
-        while (std::getline(chart_ss, tempLine)) {
-            chartNotesData += tempLine + "\n";
+        if (c == '#' && lineStart) {
+            endMeasure();
+            return pos;
         }
-        
-        std::string chartNotesDataCleaned;
-        for (char c : chartNotesData) {
-            if (c == '\r') continue;
-            chartNotesDataCleaned += c;
+        if (c == ',') {
+            endMeasure();
+            lineStart = false;
+            ++pos;
+            continue;
         }
-        
-        size_t npos = chartNotesDataCleaned.find("\n\n");
-        while (npos != std::string::npos) {
-            chartNotesDataCleaned.replace(npos, 2, "\n");
-            npos = chartNotesDataCleaned.find("\n\n");
+        if (isSmComment(src, pos)) {
+            pos = skipSmLine(src, pos);
+            lineStart = true;
+            continue;
+        }
+        if (isSmSpace(c)) {
+            if (c == '\n') lineStart = true;
+            ++pos;
+            continue;
         }
-        
-        std::stringstream measure_ss(chartNotesDataCleaned);
-        std::string measureStr;
-        int measureIndex = 0;
-        
-        while (std::getline(measure_ss, measureStr, ',')) {
-            measureStr = Utils::trim(measureStr);
-            
-            std::stringstream row_ss(measureStr);
-            std::string rowStr;
-            std::vector<std::string> rows;
-            
-            while (std::getline(row_ss, rowStr, '\n')) {
-                rowStr = Utils::trim(rowStr);
-                
-                bool hasNoteChar = false;
-                for (char c : rowStr) {
-                    if (c == '0' || c == '1' || c == '2' || c == '3' || c == '4' || c == 'M') {
-                        hasNoteChar = true;
-                        break;
-                    }
-                }
-                
-                if (!rowStr.empty() && hasNoteChar) {
-                    rows.push_back(rowStr);
-                }
-            }
-            
-            int rowsPerMeasure = rows.size();
-            
-            if (rowsPerMeasure == 0) {
-                measureIndex++;
-                continue;
-            }
 
-            float measureLengthBeats = 4.0f; 
-            
-            for (int rowIndex = 0; rowIndex < rowsPerMeasure; ++rowIndex) {
-                const std::string& noteRow = rows[rowIndex];
-                
-                float beat = (float)measureIndex * measureLengthBeats + 
-                             (float)rowIndex * (measureLengthBeats / (float)rowsPerMeasure);
-                
-                float time = calculateBeatsToSeconds(beat, offset, data.timingPoints) * 1000.0f;
-                
-                for (int col = 0; col < std::min((int)noteRow.length(), data.keyCount); ++col) {
-                    char noteTypeChar = noteRow[col];
-                    NoteType noteType = TAP;
-                    bool isNote = true;
-
-                    switch (noteTypeChar) {
-                        case '1': noteType = TAP; break;
-                        case '2': noteType = HOLD_START; break;
-                        case '3': noteType = HOLD_END; break;
-                        case 'M': noteType = MINE; break;
-                        default: isNote = false; break;
-                    }
-                    
-                    if (isNote) {
-                        data.notes.push_back({time, col, noteType});
-                    }
-                }
-            }
+        size_t start = pos;
+        bool hasNoteChar = false;
+        while (pos < src.size()) {
+            char r = src[pos];
+            if (isSmSpace(r) || r == ',' || r == ';' || isSmComment(src, pos)) break;
+            if ((r >= '0' && r <= '4') || r == 'M') hasNoteChar = true;
+            ++pos;
+        }
 
-            measureIndex++;
+        if (hasNoteChar) {
+            rows.push_back(src.substr(start, pos - start));
         }
+        lineStart = false;
     }
 
-    std::sort(data.notes.begin(), data.notes.end());
-    return data;
+    endMeasure();
+    return pos;
 }
 
-std::vector<ChartData> ChartUtils::convertSmToChartDataMultiple(const std::string& smContent) {
-    std::vector<ChartData> charts;
-    std::stringstream ss(smContent);
-    std::string line;
-    
-    float offset = 0.0f;
-    std::vector<TimingPoint> timingPoints;
-    std::map<std::string, std::string> commonMetadata;
-    
-    std::vector<std::string> notesBlocks;
-    std::string currentNotesBlock;
-    bool inNotesSection = false;
-    bool isSSC = smContent.find("#NOTEDATA:") != std::string::npos;
-
-    while (std::getline(ss, line)) {
-        size_t commentPos = line.find("//");
-        if (commentPos != std::string::npos) {
-            line = line.substr(0, commentPos);
+static std::vector<TimingSegment> parseSmSegments(const std::string& value) {
+    std::vector<TimingSegment> segments;
+
+    std::stringstream segss(value);
+    std::string entry;
+    while (std::getline(segss, entry, ',')) {
+        entry = Utils::trim(entry);
+        if (entry.empty()) continue;
+
+        size_t eqPos = entry.find('=');
+        if (eqPos != std::string::npos) {
+            try {
+                double beat = std::stod(entry.substr(0, eqPos));
+                double val = std::stod(entry.substr(eqPos + 1));
+                segments.push_back({beat, val});
+            } catch (...) {}
         }
-        
-        line = Utils::trim(line);
-        if (line.empty()) continue;
+    }
 
-        if (isSSC && line.find("#NOTEDATA:") != std::string::npos) {
-            if (inNotesSection && !currentNotesBlock.empty()) {
-                notesBlocks.push_back(currentNotesBlock);
-            }
-            inNotesSection = true;
-            currentNotesBlock.clear();
+    std::stable_sort(segments.begin(), segments.end(), [](const TimingSegment& a, const TimingSegment& b) {
+        return a.beat < b.beat;
+    });
+    return segments;
+}
+
+static bool applySmTimingTag(const std::string& tag, const std::string& value, TimingData& timing) {
+    if (tag == "OFFSET") {
+        try {
+            timing.offset = std::stod(value);
+        } catch (...) {}
+    } else if (tag == "BPMS") {
+        timing.bpms = parseSmSegments(value);
+    } else if (tag == "STOPS" || tag == "FREEZES") {
+        timing.stops = parseSmSegments(value);
+    } else if (tag == "DELAYS") {
+        timing.delays = parseSmSegments(value);
+    } else if (tag == "WARPS") {
+        timing.warps = parseSmSegments(value);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void applySmChartTag(const std::string& tag, const std::string& value, SmChartSection& section) {
+    if (applySmTimingTag(tag, value, section.timing)) {
+        section.timingTags.insert(tag);
+    } else if (tag == "STEPSTYPE") {
+        section.metadata.mode = value;
+        section.keyCount = getSmStepsTypeKeyCount(value);
+    } else if (tag == "DESCRIPTION") {
+        section.metadata.charter = value;
+    } else if (tag == "CREDIT" && !value.empty()) {
+        section.metadata.charter = value;
+    } else if (tag == "DIFFICULTY") {
+        section.metadata.difficulty = value;
+    }
+}
+
+std::vector<ChartData> ChartUtils::convertSmToChartDataMultiple(const std::string& smContent) {
+    std::string_view src = smContent;
+
+    TimingData songTiming;
+    ChartMetadata commonMetadata;
+
+    std::vector<SmChartSection> sections;
+    std::vector<std::string_view> rows;
+    bool inNoteData = false;
+
+    size_t pos = 0;
+    while (pos < src.size()) {
+        if (isSmComment(src, pos)) {
+            pos = skipSmLine(src, pos);
             continue;
         }
-        
-        if (line.find("#NOTES:") != std::string::npos) {
-            if (inNotesSection && !currentNotesBlock.empty()) {
-                notesBlocks.push_back(currentNotesBlock);
-            }
-            inNotesSection = true;
-            currentNotesBlock.clear();
+        if (src[pos] != '#') {
+            ++pos;
             continue;
         }
 
-        if (inNotesSection) {
-            currentNotesBlock += line + "\n";
-            
-            if (line.find(';') != std::string::npos) {
-                size_t semiPos = currentNotesBlock.find(';');
-                if (semiPos != std::string::npos) {
-                    currentNotesBlock = currentNotesBlock.substr(0, semiPos);
-                }
-                notesBlocks.push_back(currentNotesBlock);
-                currentNotesBlock.clear();
-                inNotesSection = false;
-            }
+        size_t colonPos = src.find_first_of(":;", pos + 1);
+        if (colonPos == std::string_view::npos) break;
+        if (src[colonPos] == ';') {
+            pos = colonPos + 1;
             continue;
         }
 
-        if (line.front() == '#') {
-            if (line.back() == ';') {
-                line = line.substr(0, line.length() - 1);
-                line = Utils::trim(line);
-            }
-            
-            size_t colonPos = line.find(':');
-            if (colonPos != std::string::npos) {
-                std::string tag = line.substr(1, colonPos - 1);
-                std::string value = line.substr(colonPos + 1);
-
-                tag = Utils::trim(tag);
-                value = Utils::trim(value);
-                
-                if (tag == "OFFSET") {
-                    try {
-                        offset = std::stof(value);
-                    } catch (...) {}
-                } else if (tag == "BPMS") {
-                    while (value.back() != ';' && std::getline(ss, line)) {
-                        line = Utils::trim(line);
-                        if (!line.empty()) {
-                            value += line;
-                        }
-                    }
-                    
-                    if (value.back() == ';') {
-                        value = value.substr(0, value.length() - 1);
-                    }
-                    
-                    std::string cleanValue = value;
-                    std::replace(cleanValue.begin(), cleanValue.end(), '\n', ',');
-                    std::replace(cleanValue.begin(), cleanValue.end(), '\r', ',');
-
-                    std::stringstream bpmss(cleanValue);
-                    std::string entry;
-                    
-                    while (std::getline(bpmss, entry, ',')) {
-                        entry = Utils::trim(entry);
-                        if (entry.empty()) continue;
-                        
-                        size_t eqPos = entry.find('=');
-                        if (eqPos != std::string::npos) {
-                            try {
-                                float beat = std::stof(entry.substr(0, eqPos)); 
-                                double val = std::stod(entry.substr(eqPos + 1));
-                                timingPoints.push_back({beat, val});
-                            } catch (...) {}
-                        }
-                    }
-                    
-                    std::sort(timingPoints.begin(), timingPoints.end(), 
-                              [](const TimingPoint& a, const TimingPoint& b) {
-                        return a.time < b.time;
-                    });
-                } else {
-                    std::string key = Utils::trim(tag);
-                    if (key == "TITLE") commonMetadata["title"] = value;
-                    else if (key == "ARTIST") commonMetadata["artist"] = value;
-                    else if (key == "CREDIT") commonMetadata["charter"] = value;
-                    else if (key == "MUSIC") commonMetadata["audio"] = value;
-                    else if (key == "BACKGROUND") commonMetadata["background"] = value;
-                    else if (key == "SAMPLESTART") commonMetadata["previewTime"] = value;
-                    else if (key == "SAMPLELENGTH") commonMetadata["previewLength"] = value;
-                    else if (key == "TITLETRANSLIT" && !value.empty()) commonMetadata["title"] = value;
-                    else if (key == "ARTISTTRANSLIT" && !value.empty()) commonMetadata["artist"] = value;
+        std::string tag(trimSmView(src.substr(pos + 1, colonPos - pos - 1)));
+        std::transform(tag.begin(), tag.end(), tag.begin(), ::toupper);
+        pos = colonPos + 1;
+
+        if (tag == "NOTES") {
+            if (!inNoteData) {
+                sections.emplace_back();
+                SmChartSection& section = sections.back();
+
+                std::string properties[5];
+                for (int i = 0; i < 5 && pos < src.size(); ++i) {
+                    size_t fieldEnd = src.find_first_of(":;", pos);
+                    if (fieldEnd == std::string_view::npos || src[fieldEnd] == ';') break;
+                    properties[i] = readSmValue(src.substr(pos, fieldEnd - pos));
+                    pos = fieldEnd + 1;
                 }
+
+                section.metadata.mode = properties[0];
+                section.keyCount = getSmStepsTypeKeyCount(properties[0]);
+                section.metadata.charter = properties[1];
+                section.metadata.difficulty = properties[2];
+            } else if (sections.empty()) {
+                sections.emplace_back();
             }
+
+            pos = parseSmNoteData(src, pos, sections.back(), rows);
+            inNoteData = false;
+            continue;
+        }
+
+        size_t valueEnd = findSmValueEnd(src, pos);
+        std::string value = readSmValue(src.substr(pos, valueEnd - pos));
+        pos = (valueEnd < src.size() && src[valueEnd] == ';') ? valueEnd + 1 : valueEnd;
+
+        if (tag == "NOTEDATA") {
+            sections.emplace_back();
+            inNoteData = true;
+            continue;
         }
-    }
 
-    if (inNotesSection && !currentNotesBlock.empty()) {
-        notesBlocks.push_back(currentNotesBlock);
+        if (inNoteData) {
+            applySmChartTag(tag, value, sections.back());
+            continue;
+        }
+
+        if (applySmTimingTag(tag, value, songTiming)) continue;
+
+        if (tag == "TITLE") commonMetadata.title = value;
+        else if (tag == "ARTIST") commonMetadata.artist = value;
+        else if (tag == "CREDIT") commonMetadata.charter = value;
+        else if (tag == "MUSIC") commonMetadata.audio = value;
+        else if (tag == "BACKGROUND") commonMetadata.background = value;
+        else if (tag == "SAMPLESTART") commonMetadata.set("previewTime", value);
+        else if (tag == "SAMPLELENGTH") commonMetadata.set("previewLength", value);
+        else if (tag == "TITLETRANSLIT" && !value.empty()) commonMetadata.title = value;
+        else if (tag == "ARTISTTRANSLIT" && !value.empty()) commonMetadata.artist = value;
     }
 
-    for (const auto& notesBlock : notesBlocks) {
-        ChartData chart = processSmNotesBlock(notesBlock, offset, timingPoints, isSSC);
-        
-        for (const auto& kv : commonMetadata) {
-            if (chart.metadata.find(kv.first) == chart.metadata.end()) {
-                chart.metadata[kv.first] = kv.second;
+    TimingMap songTimingMap(songTiming);
+
+    std::vector<ChartData> charts;
+    charts.reserve(sections.size());
+
+    for (auto& section : sections) {
+        ChartData chart;
+        chart.timing = songTiming;
+
+        // As in StepMania, a chart with any timing tag of its own drops every
+        // song segment and only keeps the song offset unless it sets one.
+        // A chart that declares no BPMS would have no tempo at all, so it
+        // keeps the song's.
+        const auto& tags = section.timingTags;
+        if (!tags.empty()) {
+            chart.timing = std::move(section.timing);
+            if (!tags.count("OFFSET")) chart.timing.offset = songTiming.offset;
+            if (!tags.count("BPMS")) chart.timing.bpms = songTiming.bpms;
+        }
+
+        TimingMap chartTimingMap;
+        if (!tags.empty()) chartTimingMap = TimingMap(chart.timing);
+        const TimingMap& timingMap = tags.empty() ? songTimingMap : chartTimingMap;
+
+        chart.timingPoints = timingMap.toTimingPoints();
+        chart.keyCount = section.keyCount > 0 ? section.keyCount : 4;
+        chart.metadata = std::move(section.metadata);
+        chart.metadata.fillMissing(commonMetadata);
+
+        // Holds that start in a warp are dropped with their end; holds that
+        // only end in one are cut off where the warp begins.
+        std::vector<bool> warpedHolds(chart.keyCount, false);
+        std::vector<bool> openHolds(chart.keyCount, false);
+        std::vector<NoteStruct> notes;
+        notes.reserve(section.notes.size());
+        for (const auto& note : section.notes) {
+            bool trackHold = note.column >= 0 && note.column < chart.keyCount;
+            if (note.type == HOLD_END && trackHold && warpedHolds[note.column]) {
+                warpedHolds[note.column] = false;
+                continue;
+            }
+            if (timingMap.isBeatWarped(note.beat) && !(note.type == HOLD_END && trackHold && openHolds[note.column])) {
+                if (note.type == HOLD_START && trackHold) warpedHolds[note.column] = true;
+                continue;
+            }
+            if (trackHold && (note.type == HOLD_START || note.type == HOLD_END)) {
+                openHolds[note.column] = note.type == HOLD_START;
             }
+
+            float time = static_cast<float>(timingMap.getSecondsAtBeat(note.beat) * 1000.0);
+            notes.push_back({time, note.column, note.type});
         }
-        
-        charts.push_back(chart);
+        chart.validation = ChartValidator::validate(chart, std::move(notes));
+        chart.hash = computeChartHash(chart);
+
+        charts.push_back(std::move(chart));
     }
 
     return charts;
@@ -724,11 +814,7 @@ std::map<std::string, ChartData> ChartUtils::parseChartMultiple(const std::strin
         ChartData data = convertOsuToChartData(content);
         data.filename = filename;
         
-        std::string diffName = "Default";
-        auto it = data.metadata.find("difficulty");
-        if (it != data.metadata.end() && !it->second.empty()) {
-            diffName = it->second;
-        }
+        std::string diffName = data.metadata.difficulty.empty() ? "Default" : data.metadata.difficulty.str();
         
         charts[diffName] = data;
     }
@@ -739,25 +825,26 @@ std::map<std::string, ChartData> ChartUtils::parseChartMultiple(const std::strin
         for (auto& chart : multipleCharts) {
             chart.filename = filename;
             
-            std::string diffName = "Default";
-            auto it = chart.metadata.find("difficulty");
-            if (it != chart.metadata.end() && !it->second.empty()) {
-                diffName = it->second;
-            }
+            std::string diffName = chart.metadata.difficulty.empty() ? "Default" : chart.metadata.difficulty.str();
             
             charts[diffName] = chart;
         }
     }
+    else if (Utils::hasEnding(filename, ".vscb"))
+    {
+        ChartData data = VscBinary::parse(content);
+        data.filename = filename;
+        
+        std::string diffName = data.metadata.difficulty.empty() ? "Default" : data.metadata.difficulty.str();
+        
+        charts[diffName] = data;
+    }
     else if (Utils::hasEnding(filename, ".vsc"))
     {
         ChartData data = parseVsc(content);
         data.filename = filename;
         
-        std::string diffName = "Default";
-        auto it = data.metadata.find("difficulty");
-        if (it != data.metadata.end() && !it->second.empty()) {
-            diffName = it->second;
-        }
+        std::string diffName = data.metadata.difficulty.empty() ? "Default" : data.metadata.difficulty.str();
         
         charts[diffName] = data;
     }
@@ -784,6 +871,10 @@ ChartData ChartUtils::parseChart(const std::string &filePath, const std::string
             data = charts[0];
         }
     }
+    else if (Utils::hasEnding(filename, ".vscb"))
+    {
+        data = VscBinary::parse(content);
+    }
     else if (Utils::hasEnding(filename, ".vsc"))
     {
         data = parseVsc(content);
@@ -0,0 +1,147 @@
+#include <utils/rhythm/ChartValidator.h>
+#include <cmath>
+
+int ChartValidationReport::total() const {
+    return invalidTimes + outOfRangeColumns + duplicateNotes + tapsOnHoldStarts + notesInsideHolds
+        + orphanedHoldEnds + unterminatedHolds + zeroLengthHolds;
+}
+
+void ChartValidationReport::merge(const ChartValidationReport& other) {
+    invalidTimes += other.invalidTimes;
+    outOfRangeColumns += other.outOfRangeColumns;
+    duplicateNotes += other.duplicateNotes;
+    tapsOnHoldStarts += other.tapsOnHoldStarts;
+    notesInsideHolds += other.notesInsideHolds;
+    orphanedHoldEnds += other.orphanedHoldEnds;
+    unterminatedHolds += other.unterminatedHolds;
+    zeroLengthHolds += other.zeroLengthHolds;
+}
+
+std::string ChartValidationReport::summary() const {
+    std::string out;
+    auto append = [&out](int count, const char* singular, const char* plural) {
+        if (count == 0) return;
+        if (!out.empty()) out += ", ";
+        out += std::to_string(count) + " " + (count == 1 ? singular : plural);
+    };
+
+    append(invalidTimes, "invalid note time", "invalid note times");
+    append(outOfRangeColumns, "out-of-range column", "out-of-range columns");
+    append(duplicateNotes, "duplicate note", "duplicate notes");
+    append(tapsOnHoldStarts, "tap on a hold start", "taps on hold starts");
+    append(notesInsideHolds, "note inside a hold", "notes inside holds");
+    append(orphanedHoldEnds, "orphaned hold end", "orphaned hold ends");
+    append(unterminatedHolds, "unterminated hold", "unterminated holds");
+    append(zeroLengthHolds, "zero-length hold", "zero-length holds");
+    return out;
+}
+
+ChartValidationReport ChartValidator::validate(ChartData& chart, std::vector<NoteStruct> input) {
+    ChartValidationReport report;
+    const int keyCount = std::max(chart.keyCount, 0);
+
+    std::erase_if(input, [&](const NoteStruct& note) {
+        bool outOfRange = note.column < 0 || note.column >= keyCount;
+        if (outOfRange) report.outOfRangeColumns++;
+        return outOfRange;
+    });
+    const int droppedColumns = report.outOfRangeColumns;
+
+    chart.notes = std::make_shared<const NoteData>(std::move(input));
+    const NoteData& notes = *chart.notes;
+
+    struct ColumnState {
+        int openHold = -1;
+        int lastIndex = -1;
+        float lastTime = -INFINITY;
+        NoteType lastType = TAP;
+        float orphanEndTime = NAN;
+    };
+    std::vector<ColumnState> columns(keyCount);
+
+    // Hold starts are patched in `output` by index when they turn out to be
+    // zero-length or unterminated.
+    std::vector<NoteStruct> output;
+    output.reserve(notes.size());
+
+    std::span<const float> times = notes.times();
+    std::span<const uint8_t> columnIds = notes.columns();
+    std::span<const uint8_t> types = notes.types();
+
+    for (size_t i = 0; i < notes.size(); ++i) {
+        float time = times[i];
+        int column = columnIds[i];
+        NoteType type = static_cast<NoteType>(types[i]);
+
+        if (!std::isfinite(time)) {
+            report.invalidTimes++;
+            continue;
+        }
+
+        ColumnState& state = columns[column];
+
+        if (type == HOLD_END) {
+            if (state.openHold < 0) {
+                report.orphanedHoldEnds++;
+                state.orphanEndTime = time;
+                continue;
+            }
+
+            NoteStruct& start = output[state.openHold];
+            state.openHold = -1;
+            if (time <= start.time) {
+                report.zeroLengthHolds++;
+                start.type = TAP;
+                continue;
+            }
+        } else {
+            if (state.openHold >= 0) {
+                report.notesInsideHolds++;
+                continue;
+            }
+            if (time == state.lastTime && type == state.lastType) {
+                report.duplicateNotes++;
+                continue;
+            }
+            // Taps sort ahead of hold starts on the same timestamp. The hold
+            // wins, so the tap already in `output` becomes its start.
+            if (type == HOLD_START && state.lastType == TAP && time == state.lastTime) {
+                report.tapsOnHoldStarts++;
+                output[state.lastIndex].type = HOLD_START;
+                state.openHold = state.lastIndex;
+                state.lastType = HOLD_START;
+                continue;
+            }
+            // Hold ends sort ahead of starts on the same timestamp, so a
+            // zero-length hold shows up as an orphaned end followed by its
+            // start. If NoteData paired the start with a later end, the
+            // orphan was a stray and the hold stands.
+            if (type == HOLD_START && time == state.orphanEndTime && notes.getPairedIndex(i) < 0) {
+                report.orphanedHoldEnds--;
+                report.zeroLengthHolds++;
+                type = TAP;
+            }
+            if (type == HOLD_START) {
+                state.openHold = static_cast<int>(output.size());
+            }
+        }
+
+        state.lastIndex = static_cast<int>(output.size());
+        state.lastTime = time;
+        state.lastType = type;
+        state.orphanEndTime = NAN;
+        output.push_back({time, column, type});
+    }
+
+    for (ColumnState& state : columns) {
+        if (state.openHold >= 0) {
+            report.unterminatedHolds++;
+            output[state.openHold].type = TAP;
+        }
+    }
+
+    if (report.total() != droppedColumns) {
+        chart.notes = std::make_shared<const NoteData>(std::move(output));
+    }
+    return report;
+}
@@ -0,0 +1,46 @@
+#include <utils/rhythm/NoteData.h>
+#include <algorithm>
+#include <unordered_map>
+
+NoteData::NoteData(std::vector<NoteStruct> notes) {
+    // Hold ends sort ahead of anything else on the same timestamp so a hold
+    // that ends where the next one in its column starts still pairs correctly.
+    auto sortKey = [](NoteType type) { return type == HOLD_END ? -1 : static_cast<int>(type); };
+    std::stable_sort(notes.begin(), notes.end(), [&](const NoteStruct& a, const NoteStruct& b) {
+        if (a.time != b.time) return a.time < b.time;
+        return sortKey(a.type) < sortKey(b.type);
+    });
+
+    times_.reserve(notes.size());
+    columns_.reserve(notes.size());
+    types_.reserve(notes.size());
+    pairedIndices_.assign(notes.size(), -1);
+
+    std::unordered_map<int, int32_t> openHolds;
+    for (size_t i = 0; i < notes.size(); ++i) {
+        const NoteStruct& note = notes[i];
+        times_.push_back(note.time);
+        columns_.push_back(static_cast<uint8_t>(note.column));
+        types_.push_back(static_cast<uint8_t>(note.type));
+
+        if (note.type == HOLD_START) {
+            openHolds[note.column] = static_cast<int32_t>(i);
+        } else if (note.type == HOLD_END) {
+            auto it = openHolds.find(note.column);
+            if (it != openHolds.end()) {
+                pairedIndices_[it->second] = static_cast<int32_t>(i);
+                pairedIndices_[i] = it->second;
+                openHolds.erase(it);
+            }
+        }
+    }
+}
+
+std::vector<NoteStruct> NoteData::toNoteStructs() const {
+    std::vector<NoteStruct> notes;
+    notes.reserve(size());
+    for (size_t i = 0; i < size(); ++i) {
+        notes.push_back(at(i));
+    }
+    return notes;
+}
@@ -12,6 +12,11 @@
 #include <sstream>
 #include <stdexcept>
 #include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
 #include <system/Logger.h>
 #include <utils/rhythm/OsuUtils.h>
 
@@ -71,6 +76,252 @@ std::string getBaseDataPath() {
     #endif
 }
 
+namespace {
+
+constexpr int OSU_DB_FLOAT_DIFFICULTY_VERSION = 20140609;
+constexpr int OSU_DB_NO_ENTRY_SIZE_VERSION = 20191106;
+constexpr int OSU_DB_FLOAT_STAR_RATING_VERSION = 20250107;
+constexpr uint8_t OSU_MODE_MANIA = 3;
+constexpr size_t OSU_DB_TIMING_POINT_SIZE = 17;
+
+// Little-endian reader over a file, refilled in large blocks so the record
+// loop never goes through the stream for individual fields.
+class OsuDbReader {
+public:
+    explicit OsuDbReader(const std::string& path)
+        : file_(path, std::ios::binary), buffer_(BUFFER_SIZE)
+    {
+        if (!file_.is_open()) {
+            throw std::runtime_error("Could not open " + path);
+        }
+    }
+
+    template <typename T>
+    T read() {
+        T value;
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+
+    bool readBool() { return read<uint8_t>() != 0; }
+
+    uint64_t readUleb128() {
+        uint64_t result = 0;
+        int shift = 0;
+        while (true) {
+            uint8_t byte = read<uint8_t>();
+            result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) break;
+            shift += 7;
+            if (shift > 63) throw std::runtime_error("Malformed ULEB128 value");
+        }
+        return result;
+    }
+
+    std::string readString() {
+        uint8_t marker = read<uint8_t>();
+        if (marker == 0x00) return std::string();
+        if (marker != 0x0b) throw std::runtime_error("Malformed string marker");
+
+        std::string value(readUleb128(), '\0');
+        readBytes(value.data(), value.size());
+        return value;
+    }
+
+    void skipString() {
+        uint8_t marker = read<uint8_t>();
+        if (marker == 0x00) return;
+        if (marker != 0x0b) throw std::runtime_error("Malformed string marker");
+        skip(readUleb128());
+    }
+
+    void readBytes(void* dst, size_t count) {
+        char* out = static_cast<char*>(dst);
+        while (count > 0) {
+            if (pos_ == end_ && !fill()) throw std::runtime_error("Unexpected end of osu! database");
+            size_t chunk = std::min(count, end_ - pos_);
+            std::memcpy(out, buffer_.data() + pos_, chunk);
+            pos_ += chunk;
+            out += chunk;
+            count -= chunk;
+        }
+    }
+
+    void skip(size_t count) {
+        while (count > 0) {
+            if (pos_ == end_ && !fill()) throw std::runtime_error("Unexpected end of osu! database");
+            size_t chunk = std::min(count, end_ - pos_);
+            pos_ += chunk;
+            count -= chunk;
+        }
+    }
+
+private:
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    std::ifstream file_;
+    std::vector<char> buffer_;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+
+    bool fill() {
+        file_.read(buffer_.data(), buffer_.size());
+        end_ = static_cast<size_t>(file_.gcount());
+        pos_ = 0;
+        return end_ > 0;
+    }
+};
+
+float readDifficultyValue(OsuDbReader& reader, int version) {
+    if (version < OSU_DB_FLOAT_DIFFICULTY_VERSION) {
+        return static_cast<float>(reader.read<uint8_t>());
+    }
+    return reader.read<float>();
+}
+
+// Returns the nomod rating from one mode's (mods, star rating) list.
+double readStarRatings(OsuDbReader& reader, int version) {
+    double nomodRating = 0.0;
+    int count = reader.read<int32_t>();
+    for (int i = 0; i < count; ++i) {
+        reader.read<uint8_t>();
+        int mods = reader.read<int32_t>();
+        reader.read<uint8_t>();
+
+        double rating = version >= OSU_DB_FLOAT_STAR_RATING_VERSION
+            ? static_cast<double>(reader.read<float>())
+            : reader.read<double>();
+        if (mods == 0) nomodRating = rating;
+    }
+    return nomodRating;
+}
+
+}
+
+std::vector<OsuBeatmapEntry> OsuUtils::readDatabase(const std::string& path) {
+    OsuDbReader reader(path);
+
+    int version = reader.read<int32_t>();
+    reader.read<int32_t>();
+    reader.readBool();
+    reader.read<int64_t>();
+    reader.skipString();
+    int beatmapCount = reader.read<int32_t>();
+
+    std::vector<OsuBeatmapEntry> beatmaps;
+    std::vector<char> rawTimingPoints;
+
+    for (int i = 0; i < beatmapCount; ++i) {
+        if (version < OSU_DB_NO_ENTRY_SIZE_VERSION) {
+            reader.read<int32_t>();
+        }
+
+        OsuBeatmapEntry entry;
+        entry.artist = reader.readString();
+        reader.skipString();
+        entry.title = reader.readString();
+        reader.skipString();
+        entry.creator = reader.readString();
+        entry.difficulty = reader.readString();
+        entry.audioFile = reader.readString();
+        entry.md5 = reader.readString();
+        entry.osuFile = reader.readString();
+
+        reader.read<uint8_t>();
+        reader.skip(3 * sizeof(int16_t));
+        reader.read<int64_t>();
+
+        readDifficultyValue(reader, version);
+        float circleSize = readDifficultyValue(reader, version);
+        entry.hpDrain = readDifficultyValue(reader, version);
+        entry.overallDifficulty = readDifficultyValue(reader, version);
+        reader.read<double>();
+
+        if (version >= OSU_DB_FLOAT_DIFFICULTY_VERSION) {
+            readStarRatings(reader, version);
+            readStarRatings(reader, version);
+            readStarRatings(reader, version);
+            entry.starRating = readStarRatings(reader, version);
+        }
+
+        reader.read<int32_t>();
+        entry.totalTime = reader.read<int32_t>();
+        entry.previewTime = reader.read<int32_t>();
+
+        // Timing points are the bulk of each record, so they are copied out raw
+        // and only decoded once the mode byte says the map is worth keeping.
+        int timingPointCount = std::max(reader.read<int32_t>(), 0);
+        rawTimingPoints.resize(static_cast<size_t>(timingPointCount) * OSU_DB_TIMING_POINT_SIZE);
+        reader.readBytes(rawTimingPoints.data(), rawTimingPoints.size());
+
+        entry.beatmapId = reader.read<int32_t>();
+        entry.beatmapSetId = reader.read<int32_t>();
+        reader.read<int32_t>();
+        reader.skip(4);
+        reader.read<int16_t>();
+        reader.read<float>();
+        uint8_t mode = reader.read<uint8_t>();
+        reader.skipString();
+        reader.skipString();
+        reader.read<int16_t>();
+        reader.skipString();
+        reader.readBool();
+        reader.read<int64_t>();
+        reader.readBool();
+        entry.folderName = reader.readString();
+        reader.read<int64_t>();
+        reader.skip(5);
+        if (version < OSU_DB_FLOAT_DIFFICULTY_VERSION) {
+            reader.read<int16_t>();
+        }
+        reader.read<int32_t>();
+        reader.read<uint8_t>();
+
+        if (mode != OSU_MODE_MANIA) continue;
+
+        entry.keyCount = std::max(1, static_cast<int>(std::lround(circleSize)));
+        entry.timingPoints.reserve(timingPointCount);
+        for (size_t offset = 0; offset < rawTimingPoints.size(); offset += OSU_DB_TIMING_POINT_SIZE) {
+            double msPerBeat, time;
+            std::memcpy(&msPerBeat, &rawTimingPoints[offset], sizeof(double));
+            std::memcpy(&time, &rawTimingPoints[offset + 8], sizeof(double));
+            bool uninherited = rawTimingPoints[offset + 16] != 0;
+
+            float timeMs = static_cast<float>(std::floor(time));
+            if (uninherited && msPerBeat > 0) {
+                entry.timingPoints.push_back({timeMs, 60000.0 / msPerBeat});
+                entry.scrollVelocities.push_back({timeMs, 1.0});
+            } else if (!uninherited && msPerBeat < 0) {
+                entry.scrollVelocities.push_back({timeMs, std::clamp(-100.0 / msPerBeat, 0.01, 10.0)});
+            }
+        }
+
+        beatmaps.push_back(std::move(entry));
+    }
+
+    return beatmaps;
+}
+
+void OsuUtils::parseDatabaseThread(const std::string& path) {
+    try {
+        GAME_LOG_INFO("OsuUtils: Starting osu! database parsing thread.");
+        auto startTime = std::chrono::steady_clock::now();
+
+        std::vector<OsuBeatmapEntry> beatmaps = readDatabase(path);
+
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+        GAME_LOG_INFO("OsuUtils: Finished osu! database parsing, " + std::to_string(beatmaps.size()) + " mania beatmaps in " + std::to_string(elapsedMs) + "ms.");
+
+        std::lock_guard<std::mutex> lock(beatmapsMutex_);
+        beatmaps_ = std::move(beatmaps);
+    } catch (const std::exception& e) {
+        GAME_LOG_ERROR(std::string("OsuUtils: Error parsing osu! database: ") + e.what());
+    } catch (...) {
+        GAME_LOG_ERROR("OsuUtils: Unknown error occurred while parsing osu! database.");
+    }
+    parsingFinished_.store(true);
+}
+
 std::string OsuUtils::getOsuDatabasePath() {
     try {
         std::string base = getBaseDataPath();
@@ -92,6 +343,7 @@ void OsuUtils::parseOsuDatabase()
     }
 
     std::string filePath = getOsuDatabasePath();
+    songsDirectory_ = (std::filesystem::path(filePath).parent_path() / "Songs").string();
     GAME_LOG_DEBUG("OsuUtils: Attempting to read osu! database at: " + filePath);
     parserThread_ = std::thread(&OsuUtils::parseDatabaseThread, this, filePath);
 }
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include <utils/rhythm/ScrollVelocityMap.h>
+#include <algorithm>
+
+ScrollVelocityMap::ScrollVelocityMap(const std::vector<ScrollVelocity>& scrollVelocities) {
+    std::vector<ScrollVelocity> sorted = scrollVelocities;
+    std::stable_sort(sorted.begin(), sorted.end(), [](const ScrollVelocity& a, const ScrollVelocity& b) {
+        return a.time < b.time;
+    });
+
+    segments_.reserve(sorted.size());
+    for (const auto& sv : sorted) {
+        if (sv.multiplier < 0.0) continue;
+
+        if (segments_.empty()) {
+            segments_.push_back({sv.time, sv.time, sv.multiplier});
+            continue;
+        }
+
+        Segment& last = segments_.back();
+        if (sv.time == last.time) {
+            last.multiplier = sv.multiplier;
+            continue;
+        }
+        if (sv.multiplier == last.multiplier) continue;
+
+        double position = last.position + (sv.time - last.time) * last.multiplier;
+        segments_.push_back({sv.time, position, sv.multiplier});
+    }
+}
+
+size_t ScrollVelocityMap::findSegment(double timeMs) const {
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), timeMs, [](double value, const Segment& seg) {
+        return value < seg.time;
+    });
+    return it == segments_.begin() ? 0 : static_cast<size_t>(it - segments_.begin()) - 1;
+}
+
+double ScrollVelocityMap::positionInSegment(size_t index, double timeMs) const {
+    const Segment& seg = segments_[index];
+    if (timeMs < seg.time) {
+        // Before the first SV change the chart scrolls at 1x.
+        return seg.position + (timeMs - seg.time);
+    }
+    return seg.position + (timeMs - seg.time) * seg.multiplier;
+}
+
+double ScrollVelocityMap::getPositionAt(double timeMs) const {
+    if (segments_.empty()) return timeMs;
+    return positionInSegment(findSegment(timeMs), timeMs);
+}
+
+double ScrollVelocityMap::getPositionAt(double timeMs, size_t& cursor) const {
+    if (segments_.empty()) return timeMs;
+
+    if (cursor >= segments_.size() || timeMs < segments_[cursor].time) {
+        cursor = findSegment(timeMs);
+    } else {
+        while (cursor + 1 < segments_.size() && segments_[cursor + 1].time <= timeMs) {
+            ++cursor;
+        }
+    }
+    return positionInSegment(cursor, timeMs);
+}
+
+double ScrollVelocityMap::getMultiplierAt(double timeMs) const {
+    if (segments_.empty() || timeMs < segments_.front().time) return 1.0;
+    return segments_[findSegment(timeMs)].multiplier;
+}
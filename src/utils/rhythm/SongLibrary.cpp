@@ -0,0 +1,168 @@
+#include <utils/rhythm/SongLibrary.h>
+#include <utils/rhythm/OsuUtils.h>
+#include <utils/Utils.h>
+#include <filesystem>
+#include <algorithm>
+
+SongEntry SongLibrary::loadSongEntry(const std::string& songDirectory, const std::vector<std::string>& chartFiles) 
+{
+    SongEntry song;
+    song.folderPath = songDirectory;
+
+    for (const auto& chartFile : chartFiles)
+    {
+        std::string fileContent = Utils::readFile(chartFile);
+        
+        std::map<std::string, ChartData> chartsFromFile = ChartUtils::parseChartMultiple(songDirectory, chartFile, fileContent);
+        
+        for (auto& [difficultyName, chartData] : chartsFromFile)
+        {
+            chartData.filePath = songDirectory;
+            chartData.filename = chartFile;
+
+            if (song.difficulties.empty()) {
+                song.title = chartData.metadata.title.empty() ? "Unknown Title" : chartData.metadata.title.str();
+                song.artist = chartData.metadata.artist.empty() ? "Unknown Artist" : chartData.metadata.artist.str();
+            }
+            
+            song.difficulties[difficultyName] = std::move(chartData);
+        }
+    }
+    
+    return song;
+}
+
+SongPack SongLibrary::buildOsuPack(const std::vector<OsuBeatmapEntry>& beatmaps, const std::string& songsDirectory)
+{
+    SongPack pack;
+    pack.name = "osu!";
+
+    std::map<std::string, SongEntry> songs;
+    for (const OsuBeatmapEntry& beatmap : beatmaps)
+    {
+        std::filesystem::path folder = std::filesystem::path(songsDirectory) / beatmap.folderName;
+        SongEntry& song = songs[beatmap.folderName];
+        if (song.difficulties.empty()) {
+            song.title = beatmap.title.empty() ? "Unknown Title" : beatmap.title;
+            song.artist = beatmap.artist.empty() ? "Unknown Artist" : beatmap.artist;
+            song.folderPath = folder.string();
+        }
+
+        ChartData chart;
+        chart.filePath = folder.string();
+        chart.filename = (folder / beatmap.osuFile).string();
+        chart.keyCount = beatmap.keyCount;
+        chart.timingPoints = beatmap.timingPoints;
+        chart.timing = TimingData::fromTimingPoints(beatmap.timingPoints);
+        chart.scrollVelocities = beatmap.scrollVelocities;
+        chart.metadata.title = beatmap.title;
+        chart.metadata.artist = beatmap.artist;
+        chart.metadata.charter = beatmap.creator;
+        chart.metadata.difficulty = beatmap.difficulty;
+        chart.metadata.audio = beatmap.audioFile;
+        if (beatmap.previewTime >= 0) chart.metadata.previewTime = beatmap.previewTime / 1000.0f;
+        chart.deferred = true;
+        chart.deferredLengthMs = static_cast<float>(std::max(beatmap.totalTime, 0));
+
+        // Two .osu files in one folder can share a difficulty name.
+        std::string difficultyName = beatmap.difficulty.empty() ? "Default" : beatmap.difficulty;
+        if (song.difficulties.count(difficultyName)) difficultyName += " [" + beatmap.osuFile + "]";
+        song.difficulties[difficultyName] = std::move(chart);
+    }
+
+    for (auto& [folderName, song] : songs) {
+        pack.songs.push_back(std::move(song));
+    }
+    return pack;
+}
+
+bool SongLibrary::loadChart(ChartData& chart)
+{
+    if (!chart.deferred) return true;
+
+    std::string content = Utils::readFile(chart.filename);
+    if (content.empty()) {
+        GAME_LOG_WARN("SongLibrary: Could not read " + chart.filename);
+        return false;
+    }
+
+    ChartData loaded = ChartUtils::parseChart(chart.filePath, chart.filename, content);
+    if (loaded.notes->empty()) {
+        GAME_LOG_WARN("SongLibrary: No notes in " + chart.filename);
+        return false;
+    }
+    loaded.filePath = chart.filePath;
+    loaded.filename = chart.filename;
+    // The .osu importer doesn't read a preview time, so the database's stays.
+    loaded.metadata.fillMissing(chart.metadata);
+    if (!loaded.validation.empty()) {
+        GAME_LOG_DEBUG("SongLibrary: Repaired " + chart.filename + ": " + loaded.validation.summary());
+    }
+
+    chart = std::move(loaded);
+    return true;
+}
+
+std::vector<SongPack> SongLibrary::build(const std::string& songsDirectory)
+{
+    std::vector<SongPack> songPacks;
+
+    std::vector<std::string> topLevelFolders = Utils::getChartList(songsDirectory);
+    SongPack miscellaneousPack;
+    miscellaneousPack.name = "Miscellaneous";
+
+    for (const auto& folderPath : topLevelFolders)
+    {
+        std::vector<std::string> chartFiles = Utils::getChartFiles(folderPath);
+
+        if (!chartFiles.empty()) {
+            miscellaneousPack.songs.push_back(loadSongEntry(folderPath, chartFiles));
+        } else {
+            SongPack newPack;
+            newPack.name = std::filesystem::path(folderPath).filename().string();
+            
+            for (const auto &subEntry : std::filesystem::directory_iterator(folderPath))
+            {
+                if (subEntry.is_directory())
+                {
+                    std::string songFolderPath = subEntry.path().string();
+                    std::vector<std::string> songChartFiles = Utils::getChartFiles(songFolderPath);
+                    
+                    if (!songChartFiles.empty()) {
+                        newPack.songs.push_back(loadSongEntry(songFolderPath, songChartFiles));
+                    }
+                }
+            }
+            
+            if (!newPack.songs.empty()) {
+                songPacks.push_back(std::move(newPack));
+            }
+        }
+    }
+    
+    if (!miscellaneousPack.songs.empty()) {
+        songPacks.push_back(std::move(miscellaneousPack));
+    }
+
+    // One summary for the whole library instead of a line per broken note.
+    ChartValidationReport validation;
+    int chartCount = 0;
+    int repairedCount = 0;
+    for (const auto& pack : songPacks) {
+        for (const auto& song : pack.songs) {
+            for (const auto& [difficultyName, chart] : song.difficulties) {
+                chartCount++;
+                if (!chart.validation.empty()) {
+                    repairedCount++;
+                    validation.merge(chart.validation);
+                    GAME_LOG_DEBUG("SongLibrary: Repaired " + chart.filename + " [" + difficultyName + "]: " + chart.validation.summary());
+                }
+            }
+        }
+    }
+    if (repairedCount > 0) {
+        GAME_LOG_WARN("SongLibrary: Repaired " + std::to_string(repairedCount) + " of " + std::to_string(chartCount) + " charts (" + validation.summary() + ")");
+    }
+
+    return songPacks;
+}
@@ -0,0 +1,268 @@
+#include <utils/rhythm/SongSearchIndex.h>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <string_view>
+
+static std::string toLowerAscii(std::string_view text) {
+    std::string lower(text);
+    for (char& c : lower) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lower;
+}
+
+static uint32_t gramKey(std::string_view gram) {
+    uint32_t key = static_cast<uint32_t>(gram.size()) << 24;
+    for (size_t i = 0; i < gram.size(); ++i) {
+        key |= static_cast<uint32_t>(static_cast<unsigned char>(gram[i])) << (16 - 8 * i);
+    }
+    return key;
+}
+
+// The BPM the chart spends the most time at, up to its last note.
+static double getDominantBpm(const ChartData& chart, float endTime) {
+    const auto& points = chart.timingPoints;
+    if (points.empty()) return 0.0;
+
+    std::unordered_map<double, double> durations;
+    for (size_t i = 0; i < points.size(); ++i) {
+        float start = std::max(points[i].time, 0.0f);
+        float end = i + 1 < points.size() ? points[i + 1].time : std::max(endTime, start);
+        durations[points[i].bpm] += std::max(0.0f, end - start);
+    }
+
+    double bestBpm = points.front().bpm;
+    double bestDuration = -1.0;
+    for (const auto& [bpm, duration] : durations) {
+        if (duration > bestDuration) {
+            bestBpm = bpm;
+            bestDuration = duration;
+        }
+    }
+    return bestBpm;
+}
+
+// Deferred charts go by the length their listing gave; anything else ends
+// at its last note.
+static float getChartLengthMs(const ChartData& chart) {
+    if (chart.deferred) return chart.deferredLengthMs;
+    const NoteData& notes = *chart.notes;
+    return notes.empty() ? 0.0f : notes.times().back();
+}
+
+bool SongSearchQuery::empty() const {
+    const SongSearchFilter defaults;
+    return terms.empty() && filter.keyCount == defaults.keyCount && !filter.hasDifficulty()
+        && filter.minBpm == defaults.minBpm && filter.maxBpm == defaults.maxBpm
+        && filter.minLength == defaults.minLength && filter.maxLength == defaults.maxLength;
+}
+
+void SongSearchIndex::clear() {
+    charts_.clear();
+    postings_.clear();
+    lastTerms_.clear();
+    lastTextMatches_.clear();
+    hasLastQuery_ = false;
+}
+
+void SongSearchIndex::build(const std::vector<SongPack>& packs) {
+    clear();
+
+    for (size_t packIdx = 0; packIdx < packs.size(); ++packIdx) {
+        const SongPack& pack = packs[packIdx];
+        for (size_t songIdx = 0; songIdx < pack.songs.size(); ++songIdx) {
+            for (const auto& [difficultyName, chart] : pack.songs[songIdx].difficulties) {
+                float lastTime = getChartLengthMs(chart);
+
+                IndexedChart indexed;
+                indexed.packIndex = static_cast<int>(packIdx);
+                indexed.songIndex = static_cast<int>(songIdx);
+                indexed.chart = &chart;
+                indexed.text = toLowerAscii(chart.metadata.title.str() + '\n' + chart.metadata.artist.str() + '\n'
+                    + chart.metadata.charter.str() + '\n' + pack.name);
+                indexed.keyCount = chart.keyCount;
+                indexed.bpm = getDominantBpm(chart, lastTime);
+                indexed.lengthSeconds = lastTime / 1000.0f;
+                charts_.push_back(std::move(indexed));
+            }
+        }
+    }
+
+    // Chart ids are added in increasing order, so every posting list comes
+    // out sorted and duplicate-free by checking only its last entry.
+    for (uint32_t id = 0; id < charts_.size(); ++id) {
+        std::string_view text = charts_[id].text;
+        for (size_t length = 1; length <= 3; ++length) {
+            for (size_t i = 0; i + length <= text.size(); ++i) {
+                std::vector<uint32_t>& list = postings_[gramKey(text.substr(i, length))];
+                if (list.empty() || list.back() != id) list.push_back(id);
+            }
+        }
+    }
+}
+
+void SongSearchIndex::updateChart(const ChartData& chart) {
+    for (IndexedChart& indexed : charts_) {
+        if (indexed.chart != &chart) continue;
+
+        float lastTime = getChartLengthMs(chart);
+        indexed.keyCount = chart.keyCount;
+        indexed.bpm = getDominantBpm(chart, lastTime);
+        indexed.lengthSeconds = lastTime / 1000.0f;
+        return;
+    }
+}
+
+SongSearchQuery SongSearchIndex::parseQuery(const std::string& text, float rate) {
+    SongSearchQuery query;
+    query.filter.rate = rate;
+
+    size_t position = 0;
+    while (position < text.size()) {
+        while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) position++;
+        size_t end = position;
+        while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end]))) end++;
+        if (end == position) break;
+
+        std::string token = toLowerAscii(std::string_view(text).substr(position, end - position));
+        position = end;
+
+        size_t opPos = token.find_first_of("<>=");
+        if (opPos != std::string::npos && opPos > 0) {
+            std::string key = token.substr(0, opPos);
+            size_t opLength = (opPos + 1 < token.size() && token[opPos + 1] == '=') ? 2 : 1;
+            std::string op = token.substr(opPos, opLength);
+            std::string_view valueText = std::string_view(token).substr(opPos + opLength);
+
+            double value = 0.0;
+            auto result = std::from_chars(valueText.data(), valueText.data() + valueText.size(), value);
+            bool parsed = result.ec == std::errc() && result.ptr == valueText.data() + valueText.size();
+
+            auto applyRange = [&](auto& minValue, auto& maxValue, double tolerance) {
+                using T = std::decay_t<decltype(minValue)>;
+                if (op == "=") {
+                    minValue = static_cast<T>(value - tolerance);
+                    maxValue = static_cast<T>(value + tolerance);
+                } else if (op[0] == '>') {
+                    minValue = static_cast<T>(value);
+                } else {
+                    maxValue = static_cast<T>(value);
+                }
+            };
+
+            if (parsed && (key == "keys" || key == "key" || key == "k") && op == "=") {
+                query.filter.keyCount = static_cast<int>(value);
+                continue;
+            } else if (parsed && key == "bpm") {
+                applyRange(query.filter.minBpm, query.filter.maxBpm, 0.5);
+                continue;
+            } else if (parsed && (key == "len" || key == "length")) {
+                applyRange(query.filter.minLength, query.filter.maxLength, 0.5);
+                continue;
+            } else if (parsed && (key == "diff" || key == "msd")) {
+                applyRange(query.filter.minDifficulty, query.filter.maxDifficulty, 0.05);
+                continue;
+            }
+        }
+
+        query.terms.push_back(std::move(token));
+    }
+
+    return query;
+}
+
+const std::vector<uint32_t>& SongSearchIndex::matchTerms(const std::vector<std::string>& terms) {
+    // Every gram of every term must be present. Terms longer than a trigram
+    // are verified against the text afterwards.
+    std::vector<const std::vector<uint32_t>*> lists;
+    bool missingGram = false;
+    bool needsVerify = false;
+    for (const auto& term : terms) {
+        size_t gramLength = std::min<size_t>(term.size(), 3);
+        needsVerify |= term.size() > 3;
+        for (size_t i = 0; i + gramLength <= term.size() && !missingGram; ++i) {
+            auto it = postings_.find(gramKey(std::string_view(term).substr(i, gramLength)));
+            if (it == postings_.end()) {
+                missingGram = true;
+            } else {
+                lists.push_back(&it->second);
+            }
+        }
+    }
+    std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+
+    auto containsAllTerms = [&](uint32_t id) {
+        for (const auto& term : terms) {
+            if (charts_[id].text.find(term) == std::string::npos) return false;
+        }
+        return true;
+    };
+
+    bool narrows = hasLastQuery_ && !lastTerms_.empty() && terms.size() >= lastTerms_.size();
+    for (size_t i = 0; narrows && i < lastTerms_.size(); ++i) {
+        narrows = terms[i].find(lastTerms_[i]) != std::string::npos;
+    }
+
+    if (terms.empty()) {
+        lastTextMatches_.resize(charts_.size());
+        for (uint32_t id = 0; id < charts_.size(); ++id) lastTextMatches_[id] = id;
+    } else if (missingGram) {
+        lastTextMatches_.clear();
+    } else if (narrows && lastTextMatches_.size() <= lists.front()->size()) {
+        std::erase_if(lastTextMatches_, [&](uint32_t id) { return !containsAllTerms(id); });
+    } else {
+        std::vector<uint32_t> matches = *lists.front();
+        std::vector<uint32_t> intersection;
+        for (size_t i = 1; i < lists.size() && !matches.empty(); ++i) {
+            intersection.clear();
+            std::set_intersection(matches.begin(), matches.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(intersection));
+            matches.swap(intersection);
+        }
+        if (needsVerify) {
+            std::erase_if(matches, [&](uint32_t id) { return !containsAllTerms(id); });
+        }
+        lastTextMatches_.swap(matches);
+    }
+
+    lastTerms_ = terms;
+    hasLastQuery_ = true;
+    return lastTextMatches_;
+}
+
+bool SongSearchIndex::passesFilter(const IndexedChart& chart, const SongSearchFilter& filter, const DifficultyLookup& difficultyLookup) const {
+    if (filter.keyCount > 0 && chart.keyCount != filter.keyCount) return false;
+
+    double bpm = chart.bpm * filter.rate;
+    if (filter.minBpm > 0.0 && bpm < filter.minBpm) return false;
+    if (filter.maxBpm > 0.0 && bpm > filter.maxBpm) return false;
+
+    float length = filter.rate > 0.0f ? chart.lengthSeconds / filter.rate : chart.lengthSeconds;
+    if (filter.minLength > 0.0f && length < filter.minLength) return false;
+    if (filter.maxLength > 0.0f && length > filter.maxLength) return false;
+
+    if (filter.hasDifficulty() && difficultyLookup) {
+        double difficulty = difficultyLookup(*chart.chart, filter.rate);
+        if (difficulty >= 0.0) {
+            if (filter.minDifficulty > 0.0 && difficulty < filter.minDifficulty) return false;
+            if (filter.maxDifficulty > 0.0 && difficulty > filter.maxDifficulty) return false;
+        }
+    }
+    return true;
+}
+
+std::vector<SongSearchMatch> SongSearchIndex::search(const SongSearchQuery& query, const DifficultyLookup& difficultyLookup) {
+    std::vector<SongSearchMatch> results;
+
+    for (uint32_t id : matchTerms(query.terms)) {
+        const IndexedChart& chart = charts_[id];
+        if (!results.empty() && results.back().packIndex == chart.packIndex && results.back().songIndex == chart.songIndex) {
+            continue;
+        }
+        if (passesFilter(chart, query.filter, difficultyLookup)) {
+            results.push_back({chart.packIndex, chart.songIndex});
+        }
+    }
+
+    return results;
+}
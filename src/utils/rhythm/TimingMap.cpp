@@ -0,0 +1,201 @@
+#include <utils/rhythm/TimingMap.h>
+#include <algorithm>
+#include <iterator>
+
+TimingData TimingData::fromTimingPoints(const std::vector<TimingPoint>& timingPoints) {
+    TimingData timing;
+
+    std::vector<TimingPoint> sorted;
+    sorted.reserve(timingPoints.size());
+    for (const auto& tp : timingPoints) {
+        if (tp.bpm > 0.0) sorted.push_back(tp);
+    }
+    if (sorted.empty()) return timing;
+
+    std::stable_sort(sorted.begin(), sorted.end(), [](const TimingPoint& a, const TimingPoint& b) {
+        return a.time < b.time;
+    });
+
+    timing.offset = -sorted.front().time / 1000.0;
+
+    double beat = 0.0;
+    timing.bpms.push_back({0.0, sorted.front().bpm});
+    for (size_t i = 1; i < sorted.size(); ++i) {
+        beat += (sorted[i].time - sorted[i - 1].time) / 1000.0 * sorted[i - 1].bpm / 60.0;
+        timing.bpms.push_back({beat, sorted[i].bpm});
+    }
+
+    return timing;
+}
+
+TimingMap::TimingMap(const TimingData& timing) {
+    build(timing);
+}
+
+TimingMap::TimingMap(const std::vector<TimingPoint>& bpmChanges, double offset) {
+    TimingData timing;
+    timing.offset = offset;
+    timing.bpms.reserve(bpmChanges.size());
+    for (const auto& tp : bpmChanges) {
+        timing.bpms.push_back({tp.time, tp.bpm});
+    }
+    build(timing);
+}
+
+void TimingMap::build(const TimingData& timing) {
+    enum EventKind { EVENT_BPM, EVENT_STOP, EVENT_DELAY, EVENT_WARP };
+    struct Event {
+        double beat;
+        EventKind kind;
+        double value;
+    };
+
+    std::vector<Event> events;
+    events.reserve(timing.bpms.size() + timing.stops.size() + timing.delays.size() + timing.warps.size());
+    for (const auto& seg : timing.bpms) events.push_back({seg.beat, EVENT_BPM, seg.value});
+    for (const auto& seg : timing.stops) events.push_back({seg.beat, EVENT_STOP, seg.value});
+    for (const auto& seg : timing.delays) events.push_back({seg.beat, EVENT_DELAY, seg.value});
+    for (const auto& seg : timing.warps) events.push_back({seg.beat, EVENT_WARP, seg.value});
+
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.beat < b.beat;
+    });
+
+    segments_.clear();
+    warps_.clear();
+    segments_.reserve(events.size() + 1);
+    segments_.push_back({0.0, -timing.offset, -timing.offset, -timing.offset, DEFAULT_BPM, 0.0, 0});
+
+    int bpmIndex = 0;
+    for (const auto& ev : events) {
+        if (ev.value <= 0.0) continue;
+
+        double beat = std::max(ev.beat, 0.0);
+        const Segment& current = segments_.back();
+
+        if (beat > current.beat) {
+            double movingStart = std::min(std::max(current.beat, current.warpEnd), beat);
+            double arrive = current.moveSeconds + (beat - movingStart) * 60.0 / current.bpm;
+            segments_.push_back({beat, arrive, arrive, arrive, current.bpm, current.warpEnd, current.bpmIndex});
+        }
+
+        Segment& seg = segments_.back();
+        switch (ev.kind) {
+            case EVENT_BPM:
+                if (ev.value != seg.bpm) {
+                    seg.bpm = ev.value;
+                    seg.bpmIndex = segments_.size() > 1 ? ++bpmIndex : bpmIndex;
+                }
+                break;
+            case EVENT_STOP:
+                seg.moveSeconds += ev.value;
+                break;
+            case EVENT_DELAY:
+                seg.noteSeconds += ev.value;
+                seg.moveSeconds += ev.value;
+                break;
+            case EVENT_WARP:
+                seg.warpEnd = std::max(seg.warpEnd, beat + ev.value);
+                if (!warps_.empty() && beat <= warps_.back().end) {
+                    warps_.back().end = std::max(warps_.back().end, beat + ev.value);
+                } else {
+                    warps_.push_back({beat, beat + ev.value});
+                }
+                break;
+        }
+    }
+}
+
+size_t TimingMap::findSegmentByBeat(double beat) const {
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), beat, [](double value, const Segment& seg) {
+        return value < seg.beat;
+    });
+    return it == segments_.begin() ? 0 : static_cast<size_t>(it - segments_.begin()) - 1;
+}
+
+size_t TimingMap::findSegmentBySeconds(double seconds) const {
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), seconds, [](double value, const Segment& seg) {
+        return value < seg.arriveSeconds;
+    });
+    return it == segments_.begin() ? 0 : static_cast<size_t>(it - segments_.begin()) - 1;
+}
+
+double TimingMap::getSecondsAtBeat(double beat) const {
+    if (segments_.empty()) {
+        return beat * 60.0 / DEFAULT_BPM;
+    }
+
+    const Segment& first = segments_.front();
+    if (beat < first.beat) {
+        return first.arriveSeconds + (beat - first.beat) * 60.0 / first.bpm;
+    }
+
+    const Segment& seg = segments_[findSegmentByBeat(beat)];
+    if (beat == seg.beat) {
+        return seg.noteSeconds;
+    }
+
+    double movingStart = std::max(seg.beat, seg.warpEnd);
+    if (beat <= movingStart) {
+        return seg.moveSeconds;
+    }
+    return seg.moveSeconds + (beat - movingStart) * 60.0 / seg.bpm;
+}
+
+double TimingMap::getBeatAtSeconds(double seconds) const {
+    if (segments_.empty()) {
+        return seconds * DEFAULT_BPM / 60.0;
+    }
+
+    const Segment& first = segments_.front();
+    if (seconds < first.arriveSeconds) {
+        return first.beat + (seconds - first.arriveSeconds) * first.bpm / 60.0;
+    }
+
+    const Segment& seg = segments_[findSegmentBySeconds(seconds)];
+    if (seconds < seg.moveSeconds) {
+        return seg.beat;
+    }
+
+    double movingStart = std::max(seg.beat, seg.warpEnd);
+    return movingStart + (seconds - seg.moveSeconds) * seg.bpm / 60.0;
+}
+
+double TimingMap::getBpmAtBeat(double beat) const {
+    if (segments_.empty()) {
+        return DEFAULT_BPM;
+    }
+    return segments_[findSegmentByBeat(beat)].bpm;
+}
+
+double TimingMap::getBpmAtSeconds(double seconds) const {
+    if (segments_.empty()) {
+        return DEFAULT_BPM;
+    }
+    return segments_[findSegmentBySeconds(seconds)].bpm;
+}
+
+int TimingMap::getBpmIndexAtSeconds(double seconds) const {
+    if (segments_.empty()) {
+        return 0;
+    }
+    return segments_[findSegmentBySeconds(seconds)].bpmIndex;
+}
+
+bool TimingMap::isBeatWarped(double beat) const {
+    auto it = std::upper_bound(warps_.begin(), warps_.end(), beat, [](double value, const WarpRange& warp) {
+        return value <= warp.start;
+    });
+    if (it == warps_.begin()) return false;
+    return beat < std::prev(it)->end;
+}
+
+std::vector<TimingPoint> TimingMap::toTimingPoints() const {
+    std::vector<TimingPoint> timingPoints;
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        const Segment& seg = segments_[i];
+        if (i > 0 && seg.bpmIndex == segments_[i - 1].bpmIndex) continue;
+        timingPoints.push_back({static_cast<float>(seg.moveSeconds * 1000.0), seg.bpm});
+    }
+    return timingPoints;
+}
@@ -0,0 +1,272 @@
+#include <utils/rhythm/VscBinary.h>
+#include <utils/rhythm/ChartValidator.h>
+#include <system/Logger.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <type_traits>
+
+static constexpr char MAGIC[4] = {'V', 'S', 'C', 'B'};
+
+template <typename T>
+using UnsignedBits = std::conditional_t<sizeof(T) == 8, uint64_t,
+    std::conditional_t<sizeof(T) == 4, uint32_t, std::conditional_t<sizeof(T) == 2, uint16_t, uint8_t>>>;
+
+// Maps float bits onto unsigned integers in the same order as the floats, so
+// sorted times give small non-negative deltas.
+static uint32_t orderedFloatBits(float value) {
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+static float floatFromOrderedBits(uint32_t ordered) {
+    uint32_t bits = (ordered & 0x80000000u) ? ordered & 0x7FFFFFFFu : ~ordered;
+    return std::bit_cast<float>(bits);
+}
+
+static int bitWidth(int maxValue) {
+    return maxValue > 0 ? static_cast<int>(std::bit_width(static_cast<unsigned>(maxValue))) : 1;
+}
+
+static void writeVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+template <typename T>
+static void writeLittleEndian(std::string& out, T value) {
+    using Bits = UnsignedBits<T>;
+    Bits bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+    }
+}
+
+static void writeString(std::string& out, std::string_view value) {
+    writeVarint(out, value.size());
+    out.append(value);
+}
+
+// Bounds-checked cursor over the input. Any overrun sets `failed` and all
+// later reads return zero, so the parser checks once per section.
+struct VscBinaryReader {
+    std::string_view data;
+    size_t position = 0;
+    bool failed = false;
+
+    bool need(size_t bytes) {
+        if (failed || data.size() - position < bytes) {
+            failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (!need(1)) return 0;
+            uint8_t byte = static_cast<uint8_t>(data[position++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        failed = true;
+        return 0;
+    }
+
+    template <typename T>
+    T readLittleEndian() {
+        using Bits = UnsignedBits<T>;
+        if (!need(sizeof(T))) return T{};
+        Bits bits = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            bits |= static_cast<Bits>(static_cast<uint8_t>(data[position++])) << (8 * i);
+        }
+        T value;
+        std::memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+
+    std::string_view readString() {
+        uint64_t length = readVarint();
+        if (!need(length)) return {};
+        std::string_view value = data.substr(position, length);
+        position += length;
+        return value;
+    }
+
+    // Guards element counts against the bytes actually left so a corrupt
+    // count cannot trigger a huge reserve.
+    uint64_t readCount(size_t minBytesPerItem) {
+        uint64_t count = readVarint();
+        if (!failed && count > (data.size() - position) / std::max<size_t>(minBytesPerItem, 1)) {
+            failed = true;
+            return 0;
+        }
+        return count;
+    }
+};
+
+bool VscBinary::isBinary(std::string_view content) {
+    return content.size() >= sizeof(MAGIC) && std::memcmp(content.data(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+std::string VscBinary::serialize(const ChartData& chartData) {
+    std::string out;
+    serialize(chartData, out);
+    return out;
+}
+
+void VscBinary::serialize(const ChartData& chartData, std::string& out) {
+    const NoteData& notes = *chartData.notes;
+    const int columnBits = bitWidth(chartData.keyCount - 1);
+    const int noteBits = columnBits + 2;
+
+    out.reserve(out.size() + 64 + chartData.timingPoints.size() * 12 + chartData.scrollVelocities.size() * 12
+        + notes.size() * 3 + (notes.size() * noteBits + 7) / 8);
+
+    out.append(MAGIC, sizeof(MAGIC));
+    writeLittleEndian<uint16_t>(out, VERSION);
+    out.push_back(static_cast<char>(chartData.keyCount));
+    out.push_back(static_cast<char>(columnBits));
+
+    std::vector<std::pair<std::string, std::string>> entries = chartData.metadata.entries();
+    writeVarint(out, entries.size());
+    for (const auto& [key, value] : entries) {
+        writeString(out, key);
+        writeString(out, value);
+    }
+
+    writeVarint(out, chartData.timingPoints.size());
+    for (const auto& tp : chartData.timingPoints) {
+        writeLittleEndian<float>(out, tp.time);
+        writeLittleEndian<double>(out, tp.bpm);
+    }
+
+    writeVarint(out, chartData.scrollVelocities.size());
+    for (const auto& sv : chartData.scrollVelocities) {
+        writeLittleEndian<float>(out, sv.time);
+        writeLittleEndian<double>(out, sv.multiplier);
+    }
+
+    // Deltas are zigzag coded so an unsorted chart still round-trips; sorted
+    // charts (everything NoteData produces) only ever use the even codes.
+    writeVarint(out, notes.size());
+    uint32_t previous = orderedFloatBits(0.0f);
+    for (float time : notes.times()) {
+        uint32_t current = orderedFloatBits(time);
+        int64_t delta = static_cast<int64_t>(current) - static_cast<int64_t>(previous);
+        writeVarint(out, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+        previous = current;
+    }
+
+    std::span<const uint8_t> columns = notes.columns();
+    std::span<const uint8_t> types = notes.types();
+    uint64_t accumulator = 0;
+    int pendingBits = 0;
+    for (size_t i = 0; i < notes.size(); ++i) {
+        accumulator |= static_cast<uint64_t>((columns[i] << 2) | (types[i] & 0x3)) << pendingBits;
+        pendingBits += noteBits;
+        while (pendingBits >= 8) {
+            out.push_back(static_cast<char>(accumulator & 0xFF));
+            accumulator >>= 8;
+            pendingBits -= 8;
+        }
+    }
+    if (pendingBits > 0) {
+        out.push_back(static_cast<char>(accumulator & 0xFF));
+    }
+}
+
+ChartData VscBinary::parse(std::string_view content) {
+    ChartData data;
+    VscBinaryReader reader{content};
+
+    if (!isBinary(content)) {
+        GAME_LOG_ERROR("VscBinary: Missing VSCB header.");
+        return data;
+    }
+    reader.position = sizeof(MAGIC);
+
+    uint16_t version = reader.readLittleEndian<uint16_t>();
+    if (version != VERSION) {
+        GAME_LOG_ERROR("VscBinary: Unsupported version " + std::to_string(version) + ".");
+        return data;
+    }
+
+    uint8_t keyCount = reader.readLittleEndian<uint8_t>();
+    uint8_t columnBits = reader.readLittleEndian<uint8_t>();
+    if (keyCount == 0 || columnBits == 0 || columnBits > 8) {
+        GAME_LOG_ERROR("VscBinary: Invalid key count or column width.");
+        return data;
+    }
+
+    uint64_t metadataCount = reader.readCount(2);
+    for (uint64_t i = 0; i < metadataCount && !reader.failed; ++i) {
+        std::string key(reader.readString());
+        std::string value(reader.readString());
+        if (!reader.failed) data.metadata.set(key, value);
+    }
+
+    uint64_t timingCount = reader.readCount(12);
+    data.timingPoints.reserve(timingCount);
+    for (uint64_t i = 0; i < timingCount && !reader.failed; ++i) {
+        float time = reader.readLittleEndian<float>();
+        double bpm = reader.readLittleEndian<double>();
+        data.timingPoints.push_back({time, bpm});
+    }
+
+    uint64_t svCount = reader.readCount(12);
+    data.scrollVelocities.reserve(svCount);
+    for (uint64_t i = 0; i < svCount && !reader.failed; ++i) {
+        float time = reader.readLittleEndian<float>();
+        double multiplier = reader.readLittleEndian<double>();
+        data.scrollVelocities.push_back({time, multiplier});
+    }
+
+    uint64_t noteCount = reader.readCount(1);
+    std::vector<NoteStruct> notes(noteCount);
+    uint32_t previous = orderedFloatBits(0.0f);
+    for (uint64_t i = 0; i < noteCount && !reader.failed; ++i) {
+        uint64_t zigzag = reader.readVarint();
+        int64_t delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        previous = static_cast<uint32_t>(static_cast<int64_t>(previous) + delta);
+        notes[i].time = floatFromOrderedBits(previous);
+    }
+
+    const int noteBits = columnBits + 2;
+    const uint64_t noteMask = (1u << noteBits) - 1;
+    if (!reader.failed && reader.need((noteCount * noteBits + 7) / 8)) {
+        const uint8_t* packed = reinterpret_cast<const uint8_t*>(content.data()) + reader.position;
+        uint64_t accumulator = 0;
+        int availableBits = 0;
+        for (uint64_t i = 0; i < noteCount; ++i) {
+            while (availableBits < noteBits) {
+                accumulator |= static_cast<uint64_t>(*packed++) << availableBits;
+                availableBits += 8;
+            }
+            uint64_t value = accumulator & noteMask;
+            accumulator >>= noteBits;
+            availableBits -= noteBits;
+
+            notes[i].column = static_cast<int>(value >> 2);
+            notes[i].type = static_cast<NoteType>(value & 0x3);
+            if (notes[i].column >= keyCount) reader.failed = true;
+        }
+    }
+
+    if (reader.failed) {
+        GAME_LOG_ERROR("VscBinary: Chart data is truncated or corrupt.");
+        return ChartData();
+    }
+
+    data.keyCount = keyCount;
+    data.timing = TimingData::fromTimingPoints(data.timingPoints);
+    data.validation = ChartValidator::validate(data, std::move(notes));
+    data.hash = ChartUtils::computeChartHash(data);
+    return data;
+}
@@ -0,0 +1,396 @@
+#include <utils/rhythm/ChartUtils.h>
+#include <utils/rhythm/SongLibrary.h>
+#include <utils/rhythm/SongSearchIndex.h>
+#include <utils/rhythm/OsuUtils.h>
+#include <utils/rhythm/VscBinary.h>
+#include <rhythm/DifficultyCalculator.h>
+#include <rhythm/DifficultyTuningSet.h>
+#include <rhythm/DifficultyEditSession.h>
+#include <utils/Utils.h>
+#include <system/Logger.h>
+#include <common/ToolUtils.h>
+#include <common/ChartEdits.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct BenchOptions {
+    fs::path corpus;
+    int iterations = 3;
+    bool library = true;
+};
+
+struct BenchFile {
+    fs::path path;
+    std::string content;
+};
+
+// Best-of-N timing for one stage; `bytes` and `notes` are per iteration.
+struct BenchStage {
+    std::string name;
+    double bestSeconds = 0.0;
+    uint64_t bytes = 0;
+    size_t notes = 0;
+    size_t charts = 0;
+};
+
+static void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: chart-bench <corpus-dir> [options]\n"
+        "  Times every importer, the VSC writer, note feature extraction, the\n"
+        "  difficulty calculator (both kernel modes), single-note edit updates,\n"
+        "  the song-select library build and search index over the charts\n"
+        "  under <corpus-dir> (see chart-generate), and osu!.db reading.\n"
+        "\n"
+        "  -n, --iterations N   runs per stage, best is reported (default: 3)\n"
+        "  --no-library         skip the library build and osu!.db stages\n");
+}
+
+static bool parseArgs(int argc, char** argv, BenchOptions& options)
+{
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-n" || arg == "--iterations") && i + 1 < argc) {
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--no-library") {
+            options.library = false;
+        } else if (arg == "-h" || arg == "--help") {
+            return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.size() != 1) return false;
+    options.corpus = positional[0];
+    return true;
+}
+
+template <typename Fn>
+static double timeBest(int iterations, Fn&& fn)
+{
+    double best = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (i == 0 || seconds < best) best = seconds;
+    }
+    return best;
+}
+
+static void printStage(const BenchStage& stage)
+{
+    double seconds = stage.bestSeconds > 0.0 ? stage.bestSeconds : 1e-9;
+    std::printf("%-14s %6zu charts %10zu notes %10s %9.2f ms %9.1f MB/s %12.0f notes/s\n",
+        stage.name.c_str(), stage.charts, stage.notes, ToolUtils::formatBytes(stage.bytes).c_str(),
+        stage.bestSeconds * 1000.0, stage.bytes / (1024.0 * 1024.0) / seconds, stage.notes / seconds);
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    Logger::getInstance().setLogLevel(LogLevel::GAME_ERROR);
+
+    const std::vector<std::string> extensions = {".vsc", ".vscb", ".osu", ".sm", ".ssc"};
+    std::vector<BenchStage> stages;
+    std::vector<ChartData> parsedCharts;
+
+    // Files are read up front so importer numbers measure parsing, not disk.
+    for (const auto& extension : extensions) {
+        std::vector<BenchFile> files;
+        for (const auto& path : ToolUtils::collectFiles(options.corpus, {extension})) {
+            files.push_back({path, Utils::readFile(path.string())});
+        }
+        if (files.empty()) continue;
+
+        BenchStage stage;
+        stage.name = "parse " + extension;
+        for (const auto& file : files) {
+            stage.bytes += file.content.size();
+            for (auto& [difficultyName, chart] : ChartUtils::parseChartMultiple("", file.path.string(), file.content)) {
+                stage.charts++;
+                stage.notes += chart.notes->size();
+                parsedCharts.push_back(std::move(chart));
+            }
+        }
+
+        stage.bestSeconds = timeBest(options.iterations, [&]() {
+            for (const auto& file : files) {
+                ChartUtils::parseChartMultiple("", file.path.string(), file.content);
+            }
+        });
+        stages.push_back(stage);
+    }
+
+    if (parsedCharts.empty()) {
+        std::fprintf(stderr, "no charts found under %s\n", options.corpus.string().c_str());
+        Logger::getInstance().shutdown();
+        return 1;
+    }
+
+    BenchStage writeStage;
+    writeStage.name = "serializeVsc";
+    writeStage.charts = parsedCharts.size();
+    for (const auto& chart : parsedCharts) {
+        writeStage.notes += chart.notes->size();
+        writeStage.bytes += ChartUtils::serializeVsc(chart).size();
+    }
+    std::string buffer;
+    writeStage.bestSeconds = timeBest(options.iterations, [&]() {
+        for (const auto& chart : parsedCharts) {
+            buffer.clear();
+            ChartUtils::serializeVsc(chart, buffer);
+        }
+    });
+    stages.push_back(writeStage);
+
+    // Binary VSC v2 of the same charts, written and read back from memory so
+    // size and throughput compare directly against the text stages.
+    BenchStage binaryWriteStage;
+    binaryWriteStage.name = "serializeVscb";
+    binaryWriteStage.charts = writeStage.charts;
+    binaryWriteStage.notes = writeStage.notes;
+    std::vector<std::string> binaryCharts;
+    for (const auto& chart : parsedCharts) {
+        binaryCharts.push_back(VscBinary::serialize(chart));
+        binaryWriteStage.bytes += binaryCharts.back().size();
+    }
+    binaryWriteStage.bestSeconds = timeBest(options.iterations, [&]() {
+        for (const auto& chart : parsedCharts) {
+            buffer.clear();
+            VscBinary::serialize(chart, buffer);
+        }
+    });
+    stages.push_back(binaryWriteStage);
+
+    BenchStage binaryReadStage = binaryWriteStage;
+    binaryReadStage.name = "parse vscb";
+    binaryReadStage.bestSeconds = timeBest(options.iterations, [&]() {
+        for (const auto& chart : binaryCharts) {
+            VscBinary::parse(chart);
+        }
+    });
+    stages.push_back(binaryReadStage);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < parsedCharts.size(); ++i) {
+        if (VscBinary::parse(binaryCharts[i]).hash != parsedCharts[i].hash) mismatches++;
+    }
+    if (mismatches > 0) {
+        std::fprintf(stderr, "%zu chart(s) changed hash after a binary round trip\n", mismatches);
+    }
+
+    // Per-note feature extraction on its own; "difficulty" minus this is the
+    // windowing and aggregation.
+    BenchStage featureStage;
+    featureStage.name = "features";
+    DifficultyTuningSet featureSet;
+    for (const auto& chart : parsedCharts) {
+        if (featureSet.add(chart, 1.0f, 0.0)) {
+            featureStage.charts++;
+            featureStage.notes += chart.notes->size();
+        }
+    }
+    featureStage.bestSeconds = timeBest(options.iterations, [&]() {
+        for (size_t i = 0; i < featureSet.size(); ++i) {
+            featureSet.prepare(i);
+        }
+    });
+    stages.push_back(featureStage);
+
+    BenchStage difficultyStage;
+    difficultyStage.name = "difficulty";
+    difficultyStage.charts = parsedCharts.size();
+    difficultyStage.notes = writeStage.notes;
+    DifficultyCalculator calculator;
+    difficultyStage.bestSeconds = timeBest(options.iterations, [&]() {
+        for (const auto& chart : parsedCharts) {
+            calculator.calculate(chart, 1.0f);
+        }
+    });
+    stages.push_back(difficultyStage);
+
+    BenchStage fastStage = difficultyStage;
+    fastStage.name = "fast kernels";
+    DifficultyCalculator fastCalculator;
+    fastCalculator.setKernels(DifficultyKernels::FAST);
+    fastStage.bestSeconds = timeBest(options.iterations, [&]() {
+        for (const auto& chart : parsedCharts) {
+            fastCalculator.calculate(chart, 1.0f);
+        }
+    });
+    stages.push_back(fastStage);
+
+    double worstDeviation = 0.0;
+    for (const auto& chart : parsedCharts) {
+        FinalResult reference = calculator.calculate(chart, 1.0f);
+        FinalResult fast = fastCalculator.calculate(chart, 1.0f);
+        const double pairs[][2] = {
+            {reference.rawDiff, fast.rawDiff}, {reference.skills.stream, fast.skills.stream},
+            {reference.skills.jumpstream, fast.skills.jumpstream}, {reference.skills.handstream, fast.skills.handstream},
+            {reference.skills.jack, fast.skills.jack}, {reference.skills.chordjack, fast.skills.chordjack},
+            {reference.skills.stamina, fast.skills.stamina},
+        };
+        for (const auto& [expected, actual] : pairs) {
+            if (expected == 0.0) continue;
+            worstDeviation = std::max(worstDeviation, std::abs(actual - expected) / std::abs(expected));
+        }
+    }
+    std::printf("difficulty: fast kernels deviate at most %.2e (tolerance %.0e)\n",
+        worstDeviation, DifficultyCalculator::FAST_KERNEL_TOLERANCE);
+
+    // Single-note edits through DifficultyEditSession, the way the editor
+    // sends them. Loading each chart's session isn't timed.
+    const size_t editsPerChart = 20;
+    size_t edits = 0;
+    double editSeconds = 0.0;
+    double slowestEdit = 0.0;
+    for (int iteration = 0; iteration < options.iterations; ++iteration) {
+        double total = 0.0;
+        edits = 0;
+        for (const auto& chart : parsedCharts) {
+            if (chart.notes->size() < 3) continue;
+
+            DifficultyEditSession session(calculator);
+            session.load(chart);
+            ChartData current = chart;
+            for (size_t i = 0; i < editsPerChart; ++i) {
+                ChartEdit edit = ChartEdits::singleNote(current, i, editsPerChart);
+                auto start = std::chrono::steady_clock::now();
+                session.update(edit.chart, edit.startMs, edit.endMs);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                total += seconds;
+                slowestEdit = std::max(slowestEdit, seconds);
+                edits++;
+                current = std::move(edit.chart);
+            }
+        }
+        if (iteration == 0 || total < editSeconds) editSeconds = total;
+    }
+    if (edits > 0) {
+        std::printf("edit: %zu single-note updates avg %.3f ms, slowest %.3f ms (full calculate avg %.3f ms)\n",
+            edits, editSeconds * 1000.0 / edits, slowestEdit * 1000.0, difficultyStage.bestSeconds * 1000.0 / parsedCharts.size());
+    }
+
+    // Every 0.1x step from 0.5x to 2.0x per chart; notes counts each rate.
+    const std::vector<float> ladder = DifficultyCalculator::rateLadder();
+    BenchStage ladderStage;
+    ladderStage.name = "rate ladder";
+    ladderStage.charts = parsedCharts.size();
+    ladderStage.notes = writeStage.notes * ladder.size();
+    ladderStage.bestSeconds = timeBest(options.iterations, [&]() {
+        for (const auto& chart : parsedCharts) {
+            calculator.calculateRates(chart, ladder);
+        }
+    });
+    stages.push_back(ladderStage);
+
+    // The same ladder with every chart on the run-time key count pipeline,
+    // to show what the 4K-8K specializations buy.
+    BenchStage genericStage = ladderStage;
+    genericStage.name = "ladder generic";
+    DifficultyCalculator genericCalculator;
+    genericCalculator.setSpecializedKeyLayouts(false);
+    genericStage.bestSeconds = timeBest(options.iterations, [&]() {
+        for (const auto& chart : parsedCharts) {
+            genericCalculator.calculateRates(chart, ladder);
+        }
+    });
+    stages.push_back(genericStage);
+
+    if (options.library) {
+        BenchStage libraryStage;
+        libraryStage.name = "library build";
+        for (const auto& file : ToolUtils::collectFiles(options.corpus, extensions)) {
+            std::error_code ec;
+            libraryStage.bytes += fs::file_size(file, ec);
+        }
+
+        size_t songs = 0;
+        std::vector<SongPack> packs;
+        libraryStage.bestSeconds = timeBest(options.iterations, [&]() {
+            packs = SongLibrary::build(options.corpus.string());
+            songs = 0;
+            libraryStage.charts = 0;
+            libraryStage.notes = 0;
+            for (const auto& pack : packs) {
+                songs += pack.songs.size();
+                for (const auto& song : pack.songs) {
+                    for (const auto& [difficultyName, chart] : song.difficulties) {
+                        libraryStage.charts++;
+                        libraryStage.notes += chart.notes->size();
+                    }
+                }
+            }
+        });
+        stages.push_back(libraryStage);
+        std::printf("library: %zu songs\n", songs);
+
+        // Reading osu!.db and turning its mania records into the "osu!" pack,
+        // which is all song select does with it before a chart is picked.
+        for (const auto& database : ToolUtils::collectFiles(options.corpus, {".db"})) {
+            BenchStage databaseStage;
+            databaseStage.name = "osu!.db";
+            std::error_code ec;
+            databaseStage.bytes = fs::file_size(database, ec);
+
+            SongPack osuPack;
+            databaseStage.bestSeconds = timeBest(options.iterations, [&]() {
+                std::vector<OsuBeatmapEntry> beatmaps = OsuUtils::readDatabase(database.string());
+                osuPack = SongLibrary::buildOsuPack(beatmaps, database.parent_path().string());
+                databaseStage.charts = beatmaps.size();
+            });
+            stages.push_back(databaseStage);
+            std::printf("osu!.db: %s, %zu mania beatmaps in %zu songs\n",
+                fs::relative(database, options.corpus).generic_string().c_str(), databaseStage.charts, osuPack.songs.size());
+        }
+
+        SongSearchIndex index;
+        double indexSeconds = timeBest(options.iterations, [&]() { index.build(packs); });
+
+        // Replays typing every song title one character at a time, which is
+        // what the song select search box sends.
+        size_t queries = 0;
+        double slowestQuery = 0.0;
+        double searchSeconds = timeBest(options.iterations, [&]() {
+            queries = 0;
+            for (const auto& pack : packs) {
+                for (const auto& song : pack.songs) {
+                    for (size_t length = 1; length <= song.title.size(); ++length) {
+                        auto start = std::chrono::steady_clock::now();
+                        index.search(SongSearchIndex::parseQuery(song.title.substr(0, length), 1.0f));
+                        slowestQuery = std::max(slowestQuery, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                        queries++;
+                    }
+                }
+            }
+        });
+        std::printf("search: index %.2f ms over %zu charts, %zu keystrokes avg %.1f us, slowest %.1f us\n",
+            indexSeconds * 1000.0, index.getChartCount(), queries,
+            queries > 0 ? searchSeconds * 1e6 / queries : 0.0, slowestQuery * 1e6);
+    }
+
+    std::printf("best of %d iteration(s)\n", options.iterations);
+    for (const auto& stage : stages) {
+        printStage(stage);
+    }
+
+    Logger::getInstance().shutdown();
+    return 0;
+}
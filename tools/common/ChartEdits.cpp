@@ -0,0 +1,41 @@
+#include <common/ChartEdits.h>
+#include <algorithm>
+
+namespace ChartEdits {
+    ChartEdit singleNote(const ChartData& chart, size_t index, size_t count)
+    {
+        ChartEdit edit{chart};
+        std::vector<NoteStruct> notes = chart.notes->toNoteStructs();
+        if (notes.size() < 3 || chart.keyCount <= 0) return edit;
+
+        const size_t last = notes.size() - 1;
+        size_t target = 1 + (last - 1) * (index + 1) / (count + 1);
+        while (target < last && notes[target].type != TAP) ++target;
+        if (target == last) return edit;
+
+        const NoteStruct note = notes[target];
+        const int otherColumn = (note.column + 1) % chart.keyCount;
+        // Half the gap to the last note at most, so nothing lands past it.
+        const float nudge = std::min(7.0f, (notes[last].time - note.time) / 2.0f);
+
+        switch (index % 3) {
+            case 0:
+                notes.erase(notes.begin() + target);
+                edit.startMs = edit.endMs = note.time;
+                break;
+            case 1:
+                notes[target].time = note.time + nudge;
+                notes[target].column = otherColumn;
+                edit.startMs = note.time;
+                edit.endMs = note.time + nudge;
+                break;
+            default:
+                notes.push_back({note.time + nudge, otherColumn, TAP});
+                edit.startMs = edit.endMs = note.time + nudge;
+                break;
+        }
+
+        edit.chart.notes = std::make_shared<const NoteData>(std::move(notes));
+        return edit;
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef CHART_EDITS_H
+#define CHART_EDITS_H
+
+#include <utils/rhythm/ChartUtils.h>
+
+// An edited copy of a chart and the chart-time range the edit touched, in
+// the form DifficultyEditSession::update() takes.
+struct ChartEdit {
+    ChartData chart;
+    float startMs = 0.0f;
+    float endMs = 0.0f;
+};
+
+namespace ChartEdits {
+    // Edit `index` of `count` evenly spread ones: removes, moves or adds a
+    // tap (cycling in that order) near (index + 1) / (count + 1) of the way
+    // through the chart. Deterministic, and the first and last notes are
+    // left alone so the edit stays incremental.
+    ChartEdit singleNote(const ChartData& chart, size_t index, size_t count);
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include <common/ToolUtils.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <sstream>
+#include <iomanip>
+
+namespace ToolUtils {
+    std::vector<std::filesystem::path> collectFiles(const std::filesystem::path& root, const std::vector<std::string>& extensions)
+    {
+        std::vector<std::filesystem::path> files;
+
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(root, ec)) {
+            files.push_back(root);
+            return files;
+        }
+
+        auto options = std::filesystem::directory_options::skip_permission_denied;
+        for (auto it = std::filesystem::recursive_directory_iterator(root, options, ec);
+             it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+        {
+            if (ec) break;
+            if (!it->is_regular_file(ec)) continue;
+
+            std::string ext = it->path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (std::find(extensions.begin(), extensions.end(), ext) != extensions.end()) {
+                files.push_back(it->path());
+            }
+        }
+
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    int resolveThreadCount(int requested)
+    {
+        if (requested > 0) return requested;
+        unsigned int cores = std::thread::hardware_concurrency();
+        return cores > 0 ? static_cast<int>(cores) : 1;
+    }
+
+    void parallelFor(size_t count, int threadCount, const std::function<void(size_t)>& task)
+    {
+        int workers = std::min<int>(resolveThreadCount(threadCount), static_cast<int>(std::max<size_t>(count, 1)));
+        std::atomic<size_t> next{0};
+
+        auto worker = [&]() {
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                task(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (int i = 1; i < workers; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::string sanitizeFileName(const std::string& name)
+    {
+        std::string result = name;
+        for (char& c : result) {
+            if (c == '/' || c == '\\' || c == ':' || c == '*' || c == '?' || c == '"' || c == '<' || c == '>' || c == '|') {
+                c = '_';
+            }
+        }
+        return result;
+    }
+
+    std::string formatBytes(uint64_t bytes)
+    {
+        static const char* units[] = {"B", "KB", "MB", "GB"};
+        double size = static_cast<double>(bytes);
+        int unit = 0;
+        while (size >= 1024.0 && unit < 3) {
+            size /= 1024.0;
+            ++unit;
+        }
+
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << size << " " << units[unit];
+        return oss.str();
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef TOOL_UTILS_H
+#define TOOL_UTILS_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+
+namespace ToolUtils {
+    // Recursively lists files under `root` whose extension (lowercase, with the
+    // dot) is in `extensions`. Sorted so runs are reproducible.
+    std::vector<std::filesystem::path> collectFiles(const std::filesystem::path& root, const std::vector<std::string>& extensions);
+
+    // Runs `task(index)` for every index in [0, count) on `threadCount` workers
+    // pulling from a shared counter. threadCount <= 0 uses every core.
+    void parallelFor(size_t count, int threadCount, const std::function<void(size_t)>& task);
+    int resolveThreadCount(int requested);
+
+    std::string sanitizeFileName(const std::string& name);
+    std::string formatBytes(uint64_t bytes);
+}
+
+#endif
@@ -0,0 +1,220 @@
+#include <utils/rhythm/ChartUtils.h>
+#include <utils/rhythm/VscBinary.h>
+#include <utils/Utils.h>
+#include <system/Logger.h>
+#include <common/ToolUtils.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct ConvertOptions {
+    fs::path input;
+    fs::path output;
+    int threads = 0;
+    bool overwrite = true;
+    bool binary = false;
+};
+
+struct ConvertResult {
+    int charts = 0;
+    size_t notes = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    int repairedCharts = 0;
+    ChartValidationReport validation;
+    std::vector<std::string> errors;
+};
+
+static void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: chart-convert <input> <output-dir> [options]\n"
+        "  Converts .osu/.sm/.ssc charts under <input> to .vsc, mirroring the\n"
+        "  directory layout below <output-dir>.\n"
+        "\n"
+        "  -j, --threads N   worker threads (default: all cores)\n"
+        "  --format F        vsc (text, default) or vscb (binary VSC v2)\n"
+        "  --no-overwrite    skip charts whose output already exists\n");
+}
+
+static bool parseArgs(int argc, char** argv, ConvertOptions& options)
+{
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format != "vsc" && format != "vscb") {
+                std::fprintf(stderr, "unknown format: %s\n", format.c_str());
+                return false;
+            }
+            options.binary = format == "vscb";
+        } else if (arg == "--no-overwrite") {
+            options.overwrite = false;
+        } else if (arg == "-h" || arg == "--help") {
+            return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.size() != 2) return false;
+    options.input = positional[0];
+    options.output = positional[1];
+    return true;
+}
+
+static ConvertResult convertFile(const fs::path& file, const ConvertOptions& options)
+{
+    ConvertResult result;
+
+    std::string content = Utils::readFile(file.string());
+    if (content.empty()) {
+        result.errors.push_back("could not read file or file is empty");
+        return result;
+    }
+    result.bytesIn = content.size();
+
+    std::map<std::string, ChartData> charts = ChartUtils::parseChartMultiple(file.parent_path().string(), file.string(), content);
+    if (charts.empty()) {
+        result.errors.push_back("no charts found");
+        return result;
+    }
+
+    fs::path relative = fs::is_directory(options.input) ? fs::relative(file.parent_path(), options.input) : fs::path();
+    fs::path outDir = options.output / relative;
+
+    std::error_code ec;
+    fs::create_directories(outDir, ec);
+    if (ec) {
+        result.errors.push_back("could not create " + outDir.string() + ": " + ec.message());
+        return result;
+    }
+
+    // One output buffer per worker, reused across every chart it converts.
+    thread_local std::string buffer;
+
+    for (const auto& [difficultyName, chart] : charts) {
+        std::string stem = file.stem().string();
+        if (charts.size() > 1) {
+            stem += " [" + ToolUtils::sanitizeFileName(difficultyName) + "]";
+        }
+        fs::path outPath = outDir / (stem + (options.binary ? ".vscb" : ".vsc"));
+
+        if (!options.overwrite && fs::exists(outPath, ec)) continue;
+
+        if (chart.notes->empty()) {
+            result.errors.push_back("[" + difficultyName + "] has no notes, skipped");
+            continue;
+        }
+
+        buffer.clear();
+        if (options.binary) {
+            VscBinary::serialize(chart, buffer);
+        } else {
+            ChartUtils::serializeVsc(chart, buffer);
+        }
+
+        std::ofstream out(outPath, std::ios::binary);
+        if (!out.is_open() || !out.write(buffer.data(), buffer.size())) {
+            result.errors.push_back("could not write " + outPath.string());
+            continue;
+        }
+
+        result.charts++;
+        result.notes += chart.notes->size();
+        if (!chart.validation.empty()) {
+            result.repairedCharts++;
+            result.validation.merge(chart.validation);
+        }
+        result.bytesOut += buffer.size();
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    ConvertOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    Logger::getInstance().setLogLevel(LogLevel::GAME_ERROR);
+
+    std::vector<fs::path> files = ToolUtils::collectFiles(options.input, {".osu", ".sm", ".ssc"});
+    if (files.empty()) {
+        std::fprintf(stderr, "no .osu/.sm/.ssc files found under %s\n", options.input.string().c_str());
+        Logger::getInstance().shutdown();
+        return 1;
+    }
+
+    int threads = ToolUtils::resolveThreadCount(options.threads);
+    std::printf("converting %zu files on %d threads\n", files.size(), threads);
+
+    std::vector<ConvertResult> results(files.size());
+    std::atomic<size_t> done{0};
+    std::mutex printMutex;
+
+    auto start = std::chrono::steady_clock::now();
+
+    ToolUtils::parallelFor(files.size(), threads, [&](size_t i) {
+        try {
+            results[i] = convertFile(files[i], options);
+        } catch (const std::exception& e) {
+            results[i].errors.push_back(std::string("exception: ") + e.what());
+        }
+
+        size_t finished = done.fetch_add(1) + 1;
+        if (!results[i].errors.empty()) {
+            std::lock_guard<std::mutex> lock(printMutex);
+            for (const auto& error : results[i].errors) {
+                std::fprintf(stderr, "%s: %s\n", files[i].string().c_str(), error.c_str());
+            }
+        }
+        if (finished % 1000 == 0) {
+            std::lock_guard<std::mutex> lock(printMutex);
+            std::printf("  %zu/%zu\n", finished, files.size());
+        }
+    });
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ConvertResult total;
+    size_t failedFiles = 0;
+    for (const auto& result : results) {
+        total.charts += result.charts;
+        total.notes += result.notes;
+        total.bytesIn += result.bytesIn;
+        total.bytesOut += result.bytesOut;
+        total.repairedCharts += result.repairedCharts;
+        total.validation.merge(result.validation);
+        if (result.charts == 0 && !result.errors.empty()) failedFiles++;
+    }
+
+    std::printf("files:   %zu (%zu failed)\n", files.size(), failedFiles);
+    std::printf("charts:  %d (%zu notes)\n", total.charts, total.notes);
+    if (total.repairedCharts > 0) {
+        std::printf("repaired: %d charts (%s)\n", total.repairedCharts, total.validation.summary().c_str());
+    }
+    std::printf("read:    %s, wrote %s\n", ToolUtils::formatBytes(total.bytesIn).c_str(), ToolUtils::formatBytes(total.bytesOut).c_str());
+    std::printf("time:    %.3fs (%.1f files/s, %.1f MB/s)\n", seconds,
+        seconds > 0 ? files.size() / seconds : 0.0,
+        seconds > 0 ? total.bytesIn / (1024.0 * 1024.0) / seconds : 0.0);
+
+    Logger::getInstance().shutdown();
+    return failedFiles == 0 ? 0 : 1;
+}
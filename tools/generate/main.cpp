@@ -0,0 +1,666 @@
+#include <utils/rhythm/ChartUtils.h>
+#include <utils/rhythm/VscBinary.h>
+#include <utils/Utils.h>
+#include <system/Logger.h>
+#include <common/ToolUtils.h>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct GenerateOptions {
+    fs::path output;
+    uint32_t seed = 1;
+    double scale = 1.0;
+    int osuDbRecords = 50000;
+    int osuDbVersion = 20250107;
+};
+
+static void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: chart-generate <output-dir> [options]\n"
+        "  Writes a synthetic chart corpus for chart-bench and chart-convert:\n"
+        "  marathons, BPM storms, 192nd-note SM measures, SSC gimmick timing, an\n"
+        "  LN-heavy kb7 chart, 18K osu!mania with heavy SV and VSC/VSCB copies, laid out as song packs,\n"
+        "  plus an osu!.db listing the .osu charts and padded out with filler beatmaps.\n"
+        "\n"
+        "  --seed N                random seed (default: 1)\n"
+        "  --scale S               length multiplier for every chart (default: 1.0)\n"
+        "  --osu-db-records N      osu!.db beatmap count, filler included (default: 50000)\n"
+        "  --osu-db-version V      osu!.db format version to write (default: 20250107)\n");
+}
+
+static bool parseArgs(int argc, char** argv, GenerateOptions& options)
+{
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--scale" && i + 1 < argc) {
+            options.scale = std::atof(argv[++i]);
+        } else if (arg == "--osu-db-records" && i + 1 < argc) {
+            options.osuDbRecords = std::atoi(argv[++i]);
+        } else if (arg == "--osu-db-version" && i + 1 < argc) {
+            options.osuDbVersion = std::atoi(argv[++i]);
+        } else if (arg == "-h" || arg == "--help") {
+            return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.size() != 1 || options.scale <= 0.0 || options.osuDbRecords < 0) return false;
+    options.output = positional[0];
+    return true;
+}
+
+static void appendf(std::string& out, const char* format, double value)
+{
+    char buffer[64];
+    int length = std::snprintf(buffer, sizeof(buffer), format, value);
+    out.append(buffer, length);
+}
+
+static int scaled(int count, double scale)
+{
+    return std::max(1, static_cast<int>(count * scale));
+}
+
+static bool writeFile(const fs::path& path, const std::string& content, uint64_t& totalBytes)
+{
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open() || !out.write(content.data(), content.size())) {
+        std::fprintf(stderr, "could not write %s\n", path.string().c_str());
+        return false;
+    }
+
+    totalBytes += content.size();
+    std::printf("  %-60s %s\n", path.string().c_str(), ToolUtils::formatBytes(content.size()).c_str());
+    return true;
+}
+
+// Emits SM/SSC measures with `rowsPerMeasure` rows. Holds and rolls are tracked
+// per column so every 2/4 gets a matching 3, `density` is the chance a row
+// has anything on it and `mineChance` sprinkles mines on free columns.
+class SmNoteWriter {
+public:
+    SmNoteWriter(std::mt19937& rng, int keyCount) : rng_(rng), keyCount_(keyCount), holdRowsLeft_(keyCount, 0) {}
+
+    void writeMeasures(std::string& out, int measures, int rowsPerMeasure, double density, double holdChance, double mineChance)
+    {
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+        std::uniform_int_distribution<int> holdLength(2, rowsPerMeasure);
+
+        for (int measure = 0; measure < measures; ++measure) {
+            for (int row = 0; row < rowsPerMeasure; ++row) {
+                bool active = chance(rng_) < density;
+                for (int column = 0; column < keyCount_; ++column) {
+                    char symbol = '0';
+                    if (holdRowsLeft_[column] > 0) {
+                        if (--holdRowsLeft_[column] == 0) symbol = '3';
+                    } else if (active && chance(rng_) < 2.0 / keyCount_) {
+                        if (chance(rng_) < holdChance) {
+                            symbol = chance(rng_) < 0.2 ? '4' : '2';
+                            holdRowsLeft_[column] = holdLength(rng_);
+                        } else {
+                            symbol = '1';
+                        }
+                    } else if (chance(rng_) < mineChance) {
+                        symbol = 'M';
+                    }
+                    out.push_back(symbol);
+                }
+                out.push_back('\n');
+            }
+            out += measure + 1 < measures ? ",\n" : "";
+        }
+
+        // Close anything still held on a trailing measure.
+        bool open = false;
+        for (int rows : holdRowsLeft_) open |= rows > 0;
+        if (open) {
+            out += ",\n";
+            for (int column = 0; column < keyCount_; ++column) {
+                out.push_back(holdRowsLeft_[column] > 0 ? '3' : '0');
+                holdRowsLeft_[column] = 0;
+            }
+            out.push_back('\n');
+            for (int row = 0; row < 3; ++row) {
+                out.append(keyCount_, '0');
+                out.push_back('\n');
+            }
+        }
+        out += ";\n";
+    }
+
+private:
+    std::mt19937& rng_;
+    int keyCount_;
+    std::vector<int> holdRowsLeft_;
+};
+
+static void appendSmHeader(std::string& out, const std::string& title, const std::string& artist, double offset)
+{
+    out += "#TITLE:" + title + ";\n";
+    out += "#ARTIST:" + artist + ";\n";
+    out += "#CREDIT:chart-generate;\n";
+    out += "#MUSIC:audio.ogg;\n";
+    out += "#BACKGROUND:bg.png;\n";
+    appendf(out, "#OFFSET:%.3f;\n", offset);
+    out += "#SAMPLESTART:30.000;\n#SAMPLELENGTH:15.000;\n";
+}
+
+static void appendSmNotesHeader(std::string& out, const std::string& stepsType, const std::string& difficulty, int meter)
+{
+    out += "\n//---------------" + stepsType + " - " + difficulty + "----------------\n";
+    out += "#NOTES:\n     " + stepsType + ":\n     chart-generate:\n     " + difficulty + ":\n";
+    out += "     " + std::to_string(meter) + ":\n     0,0,0,0,0:\n";
+}
+
+// Thirty-minute 4K marathon at 180 BPM with four difficulties of rising density.
+static std::string generateMarathon(std::mt19937& rng, double scale)
+{
+    std::string out;
+    appendSmHeader(out, "Generated Marathon", "chart-generate", -0.120);
+    out += "#BPMS:0.000=180.000;\n#STOPS:;\n";
+
+    const int measures = scaled(1350, scale);
+    const struct { const char* name; int meter; int rows; double density; } difficulties[] = {
+        {"Easy", 4, 8, 0.35}, {"Medium", 8, 8, 0.7}, {"Hard", 12, 16, 0.6}, {"Challenge", 16, 16, 0.9},
+    };
+
+    for (const auto& difficulty : difficulties) {
+        appendSmNotesHeader(out, "dance-single", difficulty.name, difficulty.meter);
+        SmNoteWriter writer(rng, 4);
+        writer.writeMeasures(out, measures, difficulty.rows, difficulty.density, 0.08, 0.01);
+    }
+    return out;
+}
+
+// A new BPM on every half beat; exercises #BPMS parsing and TimingMap building.
+static std::string generateBpmStorm(std::mt19937& rng, double scale)
+{
+    std::string out;
+    appendSmHeader(out, "BPM Storm", "chart-generate", 0.0);
+
+    const int changes = scaled(12000, scale);
+    std::uniform_real_distribution<double> bpm(60.0, 400.0);
+    out += "#BPMS:";
+    for (int i = 0; i < changes; ++i) {
+        appendf(out, "%.3f=", i * 0.5);
+        appendf(out, "%.3f", bpm(rng));
+        out += i + 1 < changes ? ",\n" : ";\n";
+    }
+
+    appendSmNotesHeader(out, "dance-single", "Hard", 12);
+    SmNoteWriter writer(rng, 4);
+    writer.writeMeasures(out, changes / 8 + 1, 8, 0.8, 0.05, 0.0);
+    return out;
+}
+
+// 192 rows per measure on dance-double; the worst case for the row scanner.
+static std::string generateDense192(std::mt19937& rng, double scale)
+{
+    std::string out;
+    appendSmHeader(out, "Dense 192nds", "chart-generate", 0.0);
+    out += "#BPMS:0.000=240.000;\n";
+
+    appendSmNotesHeader(out, "dance-double", "Challenge", 20);
+    SmNoteWriter writer(rng, 8);
+    writer.writeMeasures(out, scaled(400, scale), 192, 0.5, 0.02, 0.005);
+    return out;
+}
+
+// Ten minutes of kb7 where most notes are long holds with rice running
+// underneath; the worst case for LN-specific difficulty work.
+static std::string generateLnDense(std::mt19937& rng, double scale)
+{
+    std::string out;
+    appendSmHeader(out, "LN Density", "chart-generate", 0.0);
+    out += "#BPMS:0.000=170.000;\n";
+
+    appendSmNotesHeader(out, "kb7-single", "Challenge", 18);
+    SmNoteWriter writer(rng, 7);
+    writer.writeMeasures(out, scaled(425, scale), 16, 0.9, 0.7, 0.0);
+    return out;
+}
+
+// SSC with stops, delays and warps at song level plus a chart that overrides
+// them with its own timing, on kb7-single.
+static std::string generateGimmickSsc(std::mt19937& rng, double scale)
+{
+    std::string out;
+    out += "#VERSION:0.83;\n";
+    appendSmHeader(out, "Gimmick Timing", "chart-generate", 0.050);
+
+    const int measures = scaled(300, scale);
+    std::uniform_real_distribution<double> bpm(90.0, 260.0);
+    std::uniform_real_distribution<double> pause(0.05, 0.5);
+
+    auto appendSegments = [&](const char* tag, int every, int offset, bool isBpm) {
+        out += tag;
+        bool first = true;
+        for (int beat = offset; beat < measures * 4; beat += every) {
+            if (!first) out += ",\n";
+            appendf(out, "%.3f=", static_cast<double>(beat));
+            appendf(out, "%.3f", isBpm ? bpm(rng) : pause(rng));
+            first = false;
+        }
+        out += ";\n";
+    };
+
+    appendSegments("#BPMS:0.000=150.000,\n", 16, 16, true);
+    appendSegments("#STOPS:", 12, 6, false);
+    appendSegments("#DELAYS:", 20, 10, false);
+    appendSegments("#WARPS:", 64, 32, false);
+
+    const struct { const char* name; int meter; double density; bool ownTiming; } difficulties[] = {
+        {"Medium", 8, 0.5, false}, {"Hard", 12, 0.8, true},
+    };
+
+    for (const auto& difficulty : difficulties) {
+        out += "\n//---------------kb7-single - " + std::string(difficulty.name) + "----------------\n";
+        out += "#NOTEDATA:;\n#STEPSTYPE:kb7-single;\n#DESCRIPTION:chart-generate;\n";
+        out += "#DIFFICULTY:" + std::string(difficulty.name) + ";\n";
+        out += "#METER:" + std::to_string(difficulty.meter) + ";\n";
+        if (difficulty.ownTiming) {
+            appendSegments("#BPMS:0.000=170.000,\n", 8, 8, true);
+            appendSegments("#STOPS:", 24, 3, false);
+            appendSegments("#WARPS:", 48, 40, false);
+        }
+        out += "#NOTES:\n";
+        SmNoteWriter writer(rng, 7);
+        writer.writeMeasures(out, measures, 16, difficulty.density, 0.06, 0.0);
+    }
+    return out;
+}
+
+// 18K osu!mania at long length with an inherited (SV) point every beat and
+// the red line BPM changing every 64 beats.
+static std::string generateOsu18k(std::mt19937& rng, double scale)
+{
+    const int keyCount = 18;
+    const int beats = scaled(4000, scale);
+
+    std::string out;
+    out += "osu file format v14\n\n[General]\nAudioFilename: audio.mp3\nPreviewTime: 60000\nMode: 3\n\n";
+    out += "[Metadata]\nTitle:Eighteen Keys\nArtist:chart-generate\nCreator:chart-generate\nVersion:18K SV\n\n";
+    out += "[Difficulty]\nCircleSize:18\nOverallDifficulty:8\n\n";
+    out += "[Events]\n0,0,\"bg.png\",0,0\n\n[TimingPoints]\n";
+
+    std::uniform_real_distribution<double> bpm(140.0, 220.0);
+    std::uniform_real_distribution<double> sv(0.25, 4.0);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::uniform_int_distribution<int> columnDist(0, keyCount - 1);
+
+    std::vector<double> beatTimes;
+    beatTimes.reserve(beats + 1);
+    double time = 1000.0;
+    double beatLength = 60000.0 / 180.0;
+    for (int beat = 0; beat <= beats; ++beat) {
+        if (beat % 64 == 0) {
+            beatLength = 60000.0 / bpm(rng);
+            appendf(out, "%.0f,", time);
+            appendf(out, "%.12g,4,1,0,100,1,0\n", beatLength);
+        }
+        appendf(out, "%.0f,", time);
+        appendf(out, "%.4f,4,1,0,100,0,0\n", -100.0 / sv(rng));
+        beatTimes.push_back(time);
+        time += beatLength;
+    }
+
+    out += "\n[HitObjects]\n";
+    std::vector<double> busyUntil(keyCount, 0.0);
+    for (int beat = 0; beat < beats; ++beat) {
+        for (int division = 0; division < 4; ++division) {
+            double noteTime = beatTimes[beat] + (beatTimes[beat + 1] - beatTimes[beat]) * division / 4.0;
+            int chord = 1 + static_cast<int>(chance(rng) * 4);
+            for (int n = 0; n < chord; ++n) {
+                int column = columnDist(rng);
+                if (busyUntil[column] >= noteTime) continue;
+
+                int x = static_cast<int>((column + 0.5) * 512.0 / keyCount);
+                appendf(out, "%.0f,192,", static_cast<double>(x));
+                if (chance(rng) < 0.1) {
+                    double endTime = noteTime + (beatTimes[beat + 1] - beatTimes[beat]) * (1 + static_cast<int>(chance(rng) * 4));
+                    appendf(out, "%.0f,128,0,", noteTime);
+                    appendf(out, "%.0f:0:0:0:0:\n", endTime);
+                    busyUntil[column] = endTime;
+                } else {
+                    appendf(out, "%.0f,1,0,0:0:0:0:\n", noteTime);
+                    busyUntil[column] = noteTime;
+                }
+            }
+        }
+    }
+    return out;
+}
+
+// Field layout mirrors OsuUtils::readDatabase, including the older record
+// formats picked by `version`.
+constexpr int OSU_DB_FLOAT_DIFFICULTY_VERSION = 20140609;
+constexpr int OSU_DB_NO_ENTRY_SIZE_VERSION = 20191106;
+constexpr int OSU_DB_FLOAT_STAR_RATING_VERSION = 20250107;
+
+class OsuDbWriter {
+public:
+    explicit OsuDbWriter(int version) : version_(version) {}
+
+    template <typename T>
+    void put(std::string& out, T value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void putString(std::string& out, const std::string& value)
+    {
+        if (value.empty()) {
+            out.push_back(0x00);
+            return;
+        }
+        out.push_back(0x0b);
+        for (uint64_t length = value.size();;) {
+            uint8_t byte = length & 0x7F;
+            length >>= 7;
+            out.push_back(static_cast<char>(length ? byte | 0x80 : byte));
+            if (!length) break;
+        }
+        out += value;
+    }
+
+    void putDifficulty(std::string& out, float value)
+    {
+        if (version_ < OSU_DB_FLOAT_DIFFICULTY_VERSION) {
+            put<uint8_t>(out, static_cast<uint8_t>(value));
+        } else {
+            put<float>(out, value);
+        }
+    }
+
+    // One mode's (mods, star rating) list: nomod and DT.
+    void putStarRatings(std::string& out, double rating)
+    {
+        put<int32_t>(out, 2);
+        for (int mods : {0, 64}) {
+            put<uint8_t>(out, 0x08);
+            put<int32_t>(out, mods);
+            put<uint8_t>(out, 0x0d);
+            double value = mods == 0 ? rating : rating * 1.4;
+            if (version_ >= OSU_DB_FLOAT_STAR_RATING_VERSION) {
+                put<float>(out, static_cast<float>(value));
+            } else {
+                put<double>(out, value);
+            }
+        }
+    }
+
+    struct Record {
+        std::string artist, title, creator, difficulty, audio, osuFile, folderName;
+        uint8_t mode = 3;
+        float circleSize = 4.0f;
+        float overallDifficulty = 8.0f;
+        double starRating = 0.0;
+        int totalTime = 0;
+        int previewTime = -1;
+        int beatmapId = 0;
+        int beatmapSetId = 0;
+        // (ms per beat, time, uninherited) as stored in .osu [TimingPoints].
+        std::vector<std::tuple<double, double, bool>> timingPoints;
+    };
+
+    void putRecord(std::string& out, const Record& record)
+    {
+        std::string body;
+        putString(body, record.artist);
+        putString(body, record.artist);
+        putString(body, record.title);
+        putString(body, record.title);
+        putString(body, record.creator);
+        putString(body, record.difficulty);
+        putString(body, record.audio);
+        putString(body, std::string(32, 'f'));
+        putString(body, record.osuFile);
+
+        put<uint8_t>(body, 4);
+        for (int i = 0; i < 3; ++i) put<int16_t>(body, 0);
+        put<int64_t>(body, 0);
+
+        putDifficulty(body, 8.0f);
+        putDifficulty(body, record.circleSize);
+        putDifficulty(body, 7.0f);
+        putDifficulty(body, record.overallDifficulty);
+        put<double>(body, 1.4);
+
+        if (version_ >= OSU_DB_FLOAT_DIFFICULTY_VERSION) {
+            for (int mode = 0; mode < 4; ++mode) {
+                putStarRatings(body, mode == record.mode ? record.starRating : 0.0);
+            }
+        }
+
+        put<int32_t>(body, record.totalTime / 1000);
+        put<int32_t>(body, record.totalTime);
+        put<int32_t>(body, record.previewTime);
+
+        put<int32_t>(body, static_cast<int32_t>(record.timingPoints.size()));
+        for (const auto& [msPerBeat, time, uninherited] : record.timingPoints) {
+            put<double>(body, msPerBeat);
+            put<double>(body, time);
+            put<uint8_t>(body, uninherited ? 1 : 0);
+        }
+
+        put<int32_t>(body, record.beatmapId);
+        put<int32_t>(body, record.beatmapSetId);
+        put<int32_t>(body, 0);
+        body.append(4, static_cast<char>(9));
+        put<int16_t>(body, 0);
+        put<float>(body, 0.7f);
+        put<uint8_t>(body, record.mode);
+        putString(body, "");
+        putString(body, "chart-generate");
+        put<int16_t>(body, 0);
+        putString(body, "");
+        put<uint8_t>(body, 1);
+        put<int64_t>(body, 0);
+        put<uint8_t>(body, 0);
+        putString(body, record.folderName);
+        put<int64_t>(body, 0);
+        body.append(5, '\0');
+        if (version_ < OSU_DB_FLOAT_DIFFICULTY_VERSION) {
+            put<int16_t>(body, 0);
+        }
+        put<int32_t>(body, 0);
+        put<uint8_t>(body, 0);
+
+        if (version_ < OSU_DB_NO_ENTRY_SIZE_VERSION) {
+            put<int32_t>(out, static_cast<int32_t>(body.size()));
+        }
+        out += body;
+    }
+
+    std::string write(const std::vector<Record>& records)
+    {
+        std::string out;
+        put<int32_t>(out, version_);
+        put<int32_t>(out, 1);
+        put<uint8_t>(out, 1);
+        put<int64_t>(out, 0);
+        putString(out, "chart-generate");
+        put<int32_t>(out, static_cast<int32_t>(records.size()));
+        for (const Record& record : records) putRecord(out, record);
+        return out;
+    }
+
+private:
+    int version_;
+};
+
+// Turns a generated .osu into the database record osu! would keep for it.
+static OsuDbWriter::Record osuDbRecord(const std::string& osu, const fs::path& folderName, const std::string& osuFile)
+{
+    OsuDbWriter::Record record;
+    record.folderName = folderName.generic_string();
+    record.osuFile = osuFile;
+    record.beatmapId = 1;
+    record.beatmapSetId = 1;
+
+    std::istringstream lines(osu);
+    std::string line, section;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty() && line.front() == '[') {
+            section = line;
+            continue;
+        }
+
+        std::vector<std::string> fields = Utils::split(line, ',');
+        if (section == "[TimingPoints]" && fields.size() >= 7) {
+            record.timingPoints.emplace_back(std::atof(fields[1].c_str()), std::atof(fields[0].c_str()), fields[6] == "1");
+            continue;
+        }
+        if (section == "[HitObjects]" && fields.size() >= 4) {
+            // Holds (type bit 128) end at the first value of the extras field.
+            bool hold = (std::atoi(fields[3].c_str()) & 128) != 0 && fields.size() >= 6;
+            record.totalTime = std::max(record.totalTime, std::atoi((hold ? fields[5] : fields[2]).c_str()));
+            continue;
+        }
+
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string key = Utils::trim(line.substr(0, colon));
+        std::string value = Utils::trim(line.substr(colon + 1));
+        if (key == "Title") record.title = value;
+        else if (key == "Artist") record.artist = value;
+        else if (key == "Creator") record.creator = value;
+        else if (key == "Version") record.difficulty = value;
+        else if (key == "AudioFilename") record.audio = value;
+        else if (key == "PreviewTime") record.previewTime = std::atoi(value.c_str());
+        else if (key == "CircleSize") record.circleSize = static_cast<float>(std::atof(value.c_str()));
+        else if (key == "OverallDifficulty") record.overallDifficulty = static_cast<float>(std::atof(value.c_str()));
+    }
+    return record;
+}
+
+// Beatmaps whose folders don't exist, across all four modes, to pad the
+// database out to a realistic size. About a quarter are mania.
+static std::vector<OsuDbWriter::Record> osuDbFiller(std::mt19937& rng, int count)
+{
+    std::uniform_int_distribution<int> mode(0, 3);
+    std::uniform_int_distribution<int> keyCount(4, 10);
+    std::uniform_int_distribution<int> timingPointCount(1, 200);
+    std::uniform_real_distribution<double> bpm(90.0, 260.0);
+    std::uniform_real_distribution<double> sv(0.25, 4.0);
+    std::uniform_real_distribution<double> stars(1.0, 9.0);
+
+    std::vector<OsuDbWriter::Record> records;
+    records.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        OsuDbWriter::Record record;
+        int set = i / 4 + 100;
+        record.artist = "Filler Artist " + std::to_string(set % 97);
+        record.title = "Filler Song " + std::to_string(set);
+        record.creator = "chart-generate";
+        record.difficulty = "Difficulty " + std::to_string(i % 4);
+        record.audio = "audio.mp3";
+        record.folderName = std::to_string(set) + " Filler Artist - Filler Song " + std::to_string(set);
+        record.osuFile = record.title + " [" + record.difficulty + "].osu";
+        record.mode = static_cast<uint8_t>(mode(rng));
+        record.circleSize = record.mode == 3 ? static_cast<float>(keyCount(rng)) : 4.0f;
+        record.starRating = stars(rng);
+        record.beatmapId = i + 100;
+        record.beatmapSetId = set;
+        record.previewTime = 30000;
+
+        double time = 500.0;
+        double beatLength = 60000.0 / bpm(rng);
+        int points = timingPointCount(rng);
+        for (int point = 0; point < points; ++point) {
+            bool uninherited = point % 16 == 0;
+            if (uninherited) beatLength = 60000.0 / bpm(rng);
+            record.timingPoints.emplace_back(uninherited ? beatLength : -100.0 / sv(rng), time, uninherited);
+            time += beatLength;
+        }
+        record.totalTime = static_cast<int>(time);
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+static std::string toCrlf(const std::string& content)
+{
+    std::string out;
+    out.reserve(content.size() + content.size() / 8);
+    for (char c : content) {
+        if (c == '\n') out.push_back('\r');
+        out.push_back(c);
+    }
+    return out;
+}
+
+int main(int argc, char** argv)
+{
+    GenerateOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    Logger::getInstance().setLogLevel(LogLevel::GAME_ERROR);
+
+    std::mt19937 rng(options.seed);
+    uint64_t totalBytes = 0;
+    bool ok = true;
+
+    const fs::path pack = options.output / "Generated Pack";
+
+    std::string marathon = generateMarathon(rng, options.scale);
+    std::string dense = generateDense192(rng, options.scale);
+    std::string osu = generateOsu18k(rng, options.scale);
+
+    ok &= writeFile(options.output / "Marathon" / "marathon.sm", marathon, totalBytes);
+    ok &= writeFile(pack / "BPM Storm" / "bpm_storm.sm", generateBpmStorm(rng, options.scale), totalBytes);
+    ok &= writeFile(pack / "Dense 192nds" / "dense192.sm", dense, totalBytes);
+    ok &= writeFile(pack / "Dense 192nds CRLF" / "dense192_crlf.sm", toCrlf(dense), totalBytes);
+    ok &= writeFile(pack / "Gimmick Timing" / "gimmick.ssc", generateGimmickSsc(rng, options.scale), totalBytes);
+    ok &= writeFile(pack / "LN Density" / "ln_dense.sm", generateLnDense(rng, options.scale), totalBytes);
+    ok &= writeFile(pack / "Eighteen Keys" / "eighteen.osu", osu, totalBytes);
+
+    // VSC copies go through the real serializer so the corpus always matches
+    // whatever the current writer produces.
+    std::map<std::string, ChartData> osuCharts = ChartUtils::parseChartMultiple("", "eighteen.osu", osu);
+    for (const auto& [difficultyName, chart] : osuCharts) {
+        ok &= writeFile(pack / "Eighteen Keys VSC" / "eighteen.vsc", ChartUtils::serializeVsc(chart), totalBytes);
+        ok &= writeFile(pack / "Eighteen Keys VSCB" / "eighteen.vscb", VscBinary::serialize(chart), totalBytes);
+    }
+    std::map<std::string, ChartData> marathonCharts = ChartUtils::parseChartMultiple("", "marathon.sm", marathon);
+    for (const auto& [difficultyName, chart] : marathonCharts) {
+        fs::path path = pack / "Marathon VSC" / ("marathon [" + ToolUtils::sanitizeFileName(difficultyName) + "].vsc");
+        ok &= writeFile(path, ChartUtils::serializeVsc(chart), totalBytes);
+    }
+
+    // The filler has its own generator so the record count doesn't change the
+    // charts above, and goes first so a misread filler record shows up as a
+    // wrong or missing chart at the end.
+    std::mt19937 fillerRng(options.seed);
+    std::vector<OsuDbWriter::Record> records = osuDbFiller(fillerRng, std::max(0, options.osuDbRecords - 1));
+    records.push_back(osuDbRecord(osu, fs::path("Generated Pack") / "Eighteen Keys", "eighteen.osu"));
+    ok &= writeFile(options.output / "osu!.db", OsuDbWriter(options.osuDbVersion).write(records), totalBytes);
+
+    std::printf("wrote %s (seed %u, scale %.2f)\n", ToolUtils::formatBytes(totalBytes).c_str(), options.seed, options.scale);
+
+    Logger::getInstance().shutdown();
+    return ok ? 0 : 1;
+}
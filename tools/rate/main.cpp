@@ -0,0 +1,387 @@
+#include <utils/rhythm/ChartUtils.h>
+#include <rhythm/DifficultyCalculator.h>
+#include <utils/Utils.h>
+#include <system/Logger.h>
+#include <common/ToolUtils.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+enum class OutputFormat { JSON, CSV };
+
+struct RateOptions {
+    fs::path input;
+    fs::path output;
+    int threads = 0;
+    OutputFormat format = OutputFormat::JSON;
+    std::vector<float> rates = {1.0f};
+    DifficultyKernels kernels = DifficultyKernels::REFERENCE;
+};
+
+struct RatedChart {
+    std::string file;
+    std::string difficulty;
+    std::string title;
+    uint64_t hash = 0;
+    int keyCount = 0;
+    size_t notes = 0;
+    double milliseconds = 0.0;
+    std::vector<FinalResult> results;
+};
+
+struct RatedFile {
+    std::vector<RatedChart> charts;
+    std::vector<std::string> errors;
+};
+
+struct RunSummary {
+    size_t files = 0;
+    size_t failedFiles = 0;
+    size_t charts = 0;
+    size_t notes = 0;
+    size_t ratings = 0;
+    int threads = 0;
+    double seconds = 0.0;
+};
+
+static void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: chart-rate <input> [options]\n"
+        "  Rates every .osu/.sm/.ssc/.vsc/.vscb chart under <input> with the\n"
+        "  difficulty calculator and writes each chart's rating, skill breakdown\n"
+        "  and calculation time, followed by the run's throughput.\n"
+        "\n"
+        "  -j, --threads N     worker threads (default: all cores)\n"
+        "  -o, --output FILE   write the report to FILE (default: stdout)\n"
+        "  --format F          json (default) or csv\n"
+        "  --rates R,R,...     playback rates to rate at (default: 1.0)\n"
+        "  --ladder            every 0.1x step from 0.5x to 2.0x\n"
+        "  --kernels K         reference (default) or fast\n");
+}
+
+static bool parseRates(const std::string& list, std::vector<float>& rates)
+{
+    rates.clear();
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        float rate = std::strtof(item.c_str(), nullptr);
+        if (rate <= 0.0f) return false;
+        rates.push_back(rate);
+    }
+    return !rates.empty();
+}
+
+static bool parseArgs(int argc, char** argv, RateOptions& options)
+{
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format != "json" && format != "csv") {
+                std::fprintf(stderr, "unknown format: %s\n", format.c_str());
+                return false;
+            }
+            options.format = format == "csv" ? OutputFormat::CSV : OutputFormat::JSON;
+        } else if (arg == "--rates" && i + 1 < argc) {
+            if (!parseRates(argv[++i], options.rates)) {
+                std::fprintf(stderr, "bad rate list: %s\n", argv[i]);
+                return false;
+            }
+        } else if (arg == "--ladder") {
+            options.rates = DifficultyCalculator::rateLadder();
+        } else if (arg == "--kernels" && i + 1 < argc) {
+            std::string kernels = argv[++i];
+            if (kernels != "reference" && kernels != "fast") {
+                std::fprintf(stderr, "unknown kernels: %s\n", kernels.c_str());
+                return false;
+            }
+            options.kernels = kernels == "fast" ? DifficultyKernels::FAST : DifficultyKernels::REFERENCE;
+        } else if (arg == "-h" || arg == "--help") {
+            return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.size() != 1) return false;
+    options.input = positional[0];
+    return true;
+}
+
+static RatedFile rateFile(const fs::path& file, const RateOptions& options, const DifficultyCalculator& calculator)
+{
+    RatedFile result;
+
+    std::string content = Utils::readFile(file.string());
+    if (content.empty()) {
+        result.errors.push_back("could not read file or file is empty");
+        return result;
+    }
+
+    std::map<std::string, ChartData> charts = ChartUtils::parseChartMultiple(file.parent_path().string(), file.string(), content);
+    if (charts.empty()) {
+        result.errors.push_back("no charts found");
+        return result;
+    }
+
+    fs::path relative = fs::is_directory(options.input) ? fs::relative(file, options.input) : file.filename();
+
+    for (const auto& [difficultyName, chart] : charts) {
+        RatedChart rated;
+        rated.file = relative.generic_string();
+        rated.difficulty = difficultyName;
+        rated.title = std::string(chart.metadata.title);
+        rated.hash = chart.hash;
+        rated.keyCount = chart.keyCount;
+        rated.notes = chart.notes->size();
+
+        // Files are already spread over every core, so each chart's rates
+        // stay on this thread.
+        auto start = std::chrono::steady_clock::now();
+        rated.results = calculator.calculateRates(chart, options.rates, 1);
+        rated.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        result.charts.push_back(std::move(rated));
+    }
+
+    return result;
+}
+
+// The default round-trips every double, so ratings can be diffed for exact
+// changes between runs.
+static std::string formatNumber(double value, const char* format = "%.17g")
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), format, value);
+    return buffer;
+}
+
+static std::string formatHash(uint64_t hash)
+{
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016" PRIx64, hash);
+    return buffer;
+}
+
+static std::string jsonString(const std::string& value)
+{
+    std::string out = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+static std::string csvField(const std::string& value)
+{
+    if (value.find_first_of(",\"\r\n") == std::string::npos) return value;
+
+    std::string out = "\"";
+    for (char c : value) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static std::vector<std::pair<const char*, double>> skillFields(const SkillResult& skills)
+{
+    return {
+        {"stream", skills.stream}, {"jumpstream", skills.jumpstream}, {"handstream", skills.handstream},
+        {"jack", skills.jack}, {"chordjack", skills.chordjack}, {"technical", skills.technical},
+        {"stamina", skills.stamina}, {"density", skills.density}, {"speed", skills.speed},
+        {"shields", skills.shields}, {"complexity", skills.complexity},
+    };
+}
+
+static void writeJson(std::ostream& out, const std::vector<RatedChart>& charts, const RunSummary& summary, const RateOptions& options)
+{
+    out << "{\n";
+    out << "  \"algorithmVersion\": " << DifficultyCalculator::ALGORITHM_VERSION << ",\n";
+    out << "  \"kernels\": " << jsonString(options.kernels == DifficultyKernels::FAST ? "fast" : "reference") << ",\n";
+    out << "  \"threads\": " << summary.threads << ",\n";
+    out << "  \"files\": " << summary.files << ",\n";
+    out << "  \"failedFiles\": " << summary.failedFiles << ",\n";
+    out << "  \"notes\": " << summary.notes << ",\n";
+    out << "  \"ratings\": " << summary.ratings << ",\n";
+    out << "  \"seconds\": " << formatNumber(summary.seconds, "%.3f") << ",\n";
+    out << "  \"chartsPerSecond\": " << formatNumber(summary.seconds > 0 ? summary.charts / summary.seconds : 0.0, "%.1f") << ",\n";
+    out << "  \"notesPerSecond\": " << formatNumber(summary.seconds > 0 ? summary.notes * options.rates.size() / summary.seconds : 0.0, "%.0f") << ",\n";
+    out << "  \"charts\": [";
+
+    for (size_t i = 0; i < charts.size(); ++i) {
+        const RatedChart& chart = charts[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"file\": " << jsonString(chart.file)
+            << ", \"difficulty\": " << jsonString(chart.difficulty)
+            << ", \"title\": " << jsonString(chart.title)
+            << ", \"hash\": " << jsonString(formatHash(chart.hash))
+            << ", \"keyCount\": " << chart.keyCount
+            << ", \"notes\": " << chart.notes
+            << ", \"ms\": " << formatNumber(chart.milliseconds, "%.3f")
+            << ", \"results\": [";
+
+        for (size_t r = 0; r < chart.results.size(); ++r) {
+            const FinalResult& result = chart.results[r];
+            out << (r == 0 ? "\n" : ",\n");
+            out << "      {\"rate\": " << formatNumber(result.playbackRate, "%g")
+                << ", \"rating\": " << formatNumber(result.rawDiff)
+                << ", \"rice\": " << formatNumber(result.riceTotal)
+                << ", \"ln\": " << formatNumber(result.lnTotal)
+                << ", \"minBpm\": " << formatNumber(result.minBPM)
+                << ", \"maxBpm\": " << formatNumber(result.maxBPM)
+                << ", \"skills\": {";
+            bool first = true;
+            for (const auto& [name, value] : skillFields(result.skills)) {
+                out << (first ? "" : ", ") << "\"" << name << "\": " << formatNumber(value);
+                first = false;
+            }
+            out << "}}";
+        }
+        out << "\n    ]}";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+static void writeCsv(std::ostream& out, const std::vector<RatedChart>& charts)
+{
+    out << "file,difficulty,title,hash,keys,notes,rate,rating,rice,ln";
+    for (const auto& [name, value] : skillFields(SkillResult{})) {
+        out << "," << name;
+    }
+    out << ",min_bpm,max_bpm,ms\n";
+
+    // `ms` covers every rate of the chart, so it repeats on each of its rows.
+    for (const RatedChart& chart : charts) {
+        for (const FinalResult& result : chart.results) {
+            out << csvField(chart.file) << "," << csvField(chart.difficulty) << "," << csvField(chart.title) << ","
+                << formatHash(chart.hash) << "," << chart.keyCount << "," << chart.notes << ","
+                << formatNumber(result.playbackRate, "%g") << "," << formatNumber(result.rawDiff) << ","
+                << formatNumber(result.riceTotal) << "," << formatNumber(result.lnTotal);
+            for (const auto& [name, value] : skillFields(result.skills)) {
+                out << "," << formatNumber(value);
+            }
+            out << "," << formatNumber(result.minBPM) << "," << formatNumber(result.maxBPM)
+                << "," << formatNumber(chart.milliseconds, "%.3f") << "\n";
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    RateOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    Logger::getInstance().setLogLevel(LogLevel::GAME_ERROR);
+
+    std::vector<fs::path> files = ToolUtils::collectFiles(options.input, {".osu", ".sm", ".ssc", ".vsc", ".vscb"});
+    if (files.empty()) {
+        std::fprintf(stderr, "no charts found under %s\n", options.input.string().c_str());
+        Logger::getInstance().shutdown();
+        return 1;
+    }
+
+    DifficultyCalculator calculator;
+    calculator.setKernels(options.kernels);
+
+    RunSummary summary;
+    summary.files = files.size();
+    summary.threads = ToolUtils::resolveThreadCount(options.threads);
+
+    std::vector<RatedFile> results(files.size());
+    std::mutex printMutex;
+
+    auto start = std::chrono::steady_clock::now();
+
+    ToolUtils::parallelFor(files.size(), summary.threads, [&](size_t i) {
+        try {
+            results[i] = rateFile(files[i], options, calculator);
+        } catch (const std::exception& e) {
+            results[i].errors.push_back(std::string("exception: ") + e.what());
+        }
+
+        if (!results[i].errors.empty()) {
+            std::lock_guard<std::mutex> lock(printMutex);
+            for (const auto& error : results[i].errors) {
+                std::fprintf(stderr, "%s: %s\n", files[i].string().c_str(), error.c_str());
+            }
+        }
+    });
+
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<RatedChart> charts;
+    for (auto& result : results) {
+        if (result.charts.empty() && !result.errors.empty()) summary.failedFiles++;
+        for (auto& chart : result.charts) {
+            summary.notes += chart.notes;
+            summary.ratings += chart.results.size();
+            charts.push_back(std::move(chart));
+        }
+    }
+    summary.charts = charts.size();
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output, std::ios::binary);
+        if (!file.is_open()) {
+            std::fprintf(stderr, "could not write %s\n", options.output.string().c_str());
+            Logger::getInstance().shutdown();
+            return 1;
+        }
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+
+    if (options.format == OutputFormat::CSV) {
+        writeCsv(out, charts);
+    } else {
+        writeJson(out, charts, summary, options);
+    }
+    out.flush();
+
+    // Goes to stderr so a report on stdout stays machine-readable.
+    std::fprintf(stderr, "rated %zu charts (%zu ratings, %zu notes) from %zu files in %.3fs on %d threads: %.1f charts/s, %.0f notes/s\n",
+        summary.charts, summary.ratings, summary.notes, summary.files, summary.seconds, summary.threads,
+        summary.seconds > 0 ? summary.charts / summary.seconds : 0.0,
+        summary.seconds > 0 ? summary.notes * options.rates.size() / summary.seconds : 0.0);
+
+    Logger::getInstance().shutdown();
+    return summary.failedFiles == 0 ? 0 : 1;
+}
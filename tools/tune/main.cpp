@@ -0,0 +1,347 @@
+#include <utils/rhythm/ChartUtils.h>
+#include <rhythm/DifficultyTuningSet.h>
+#include <utils/Utils.h>
+#include <system/Logger.h>
+#include <common/ToolUtils.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct ConfigField {
+    const char* name;
+    double DifficultyConfig::* member;
+};
+
+static const std::vector<ConfigField> CONFIG_FIELDS = {
+    {"W_RICE_FINAL", &DifficultyConfig::W_RICE_FINAL},
+    {"W_LN_FINAL", &DifficultyConfig::W_LN_FINAL},
+    {"P_NORM_EXPONENT", &DifficultyConfig::P_NORM_EXPONENT},
+    {"RICE_SKILL_EXPONENT", &DifficultyConfig::RICE_SKILL_EXPONENT},
+    {"LN_SKILL_EXPONENT", &DifficultyConfig::LN_SKILL_EXPONENT},
+    {"W_RICE_STREAM", &DifficultyConfig::W_RICE_STREAM},
+    {"W_RICE_JUMPSTREAM", &DifficultyConfig::W_RICE_JUMPSTREAM},
+    {"W_RICE_HANDSTREAM", &DifficultyConfig::W_RICE_HANDSTREAM},
+    {"W_RICE_STAMINA", &DifficultyConfig::W_RICE_STAMINA},
+    {"W_RICE_JACK", &DifficultyConfig::W_RICE_JACK},
+    {"W_RICE_CHORDJACK", &DifficultyConfig::W_RICE_CHORDJACK},
+    {"W_RICE_TECHNICAL", &DifficultyConfig::W_RICE_TECHNICAL},
+    {"W_LN_DENSITY", &DifficultyConfig::W_LN_DENSITY},
+    {"W_LN_SPEED", &DifficultyConfig::W_LN_SPEED},
+    {"W_LN_SHIELDS", &DifficultyConfig::W_LN_SHIELDS},
+    {"W_LN_COMPLEXITY", &DifficultyConfig::W_LN_COMPLEXITY},
+    {"BPM_BASE", &DifficultyConfig::BPM_BASE},
+    {"BPM_SCALE_EXPONENT", &DifficultyConfig::BPM_SCALE_EXPONENT},
+    {"MAX_BPM_RATIO", &DifficultyConfig::MAX_BPM_RATIO},
+    {"WINDOW_MS", &DifficultyConfig::WINDOW_MS},
+    {"WINDOW_OVERLAP_MS", &DifficultyConfig::WINDOW_OVERLAP_MS},
+    {"DIFF_BASE_EXPONENT", &DifficultyConfig::DIFF_BASE_EXPONENT},
+    {"JACK_MIN_INTERVAL_MS", &DifficultyConfig::JACK_MIN_INTERVAL_MS},
+    {"STAMINA_WINDOW_S", &DifficultyConfig::STAMINA_WINDOW_S},
+};
+
+// The fields only aggregation reads; tuning these reuses every window.
+static const std::vector<std::string> DEFAULT_PARAMS = {
+    "W_RICE_FINAL", "W_LN_FINAL", "P_NORM_EXPONENT",
+    "W_RICE_STREAM", "W_RICE_JUMPSTREAM", "W_RICE_HANDSTREAM", "W_RICE_STAMINA",
+    "W_RICE_JACK", "W_RICE_CHORDJACK", "W_RICE_TECHNICAL",
+    "W_LN_DENSITY", "W_LN_SPEED", "W_LN_SHIELDS", "W_LN_COMPLEXITY",
+};
+
+struct TuneOptions {
+    fs::path labels;
+    int threads = 0;
+    int sweeps = 20;
+    double step = 0.1;
+    double minStep = 0.001;
+    std::vector<std::string> params = DEFAULT_PARAMS;
+    DifficultyKernels kernels = DifficultyKernels::REFERENCE;
+};
+
+struct ErrorMetrics {
+    double rmse = 0.0;
+    double meanAbsolute = 0.0;
+    double maxAbsolute = 0.0;
+    size_t worstSample = 0;
+    double correlation = 0.0;
+};
+
+static void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: chart-tune <labels> [options]\n"
+        "  Fits DifficultyConfig values to a labelled reference set by coordinate\n"
+        "  descent on the RMS rating error. <labels> has one sample per line:\n"
+        "    <chart path>,<difficulty>,<rate>,<target rating>\n"
+        "  Paths are relative to the labels file, an empty difficulty picks a\n"
+        "  file's only chart and lines starting with # are skipped.\n"
+        "\n"
+        "  -j, --threads N     worker threads (default: all cores)\n"
+        "  --params P,P,...    config fields to tune (default: the rating weights\n"
+        "                      and P_NORM_EXPONENT, which reuse cached windows)\n"
+        "  --sweeps N          most passes over the fields (default: 20)\n"
+        "  --step S            first relative step (default: 0.1)\n"
+        "  --min-step S        stop once the step halves below S (default: 0.001)\n"
+        "  --kernels K         reference (default) or fast\n");
+}
+
+static const ConfigField* findField(const std::string& name)
+{
+    for (const auto& field : CONFIG_FIELDS) {
+        if (name == field.name) return &field;
+    }
+    return nullptr;
+}
+
+static bool parseArgs(int argc, char** argv, TuneOptions& options)
+{
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--params" && i + 1 < argc) {
+            options.params.clear();
+            std::stringstream stream(argv[++i]);
+            std::string name;
+            while (std::getline(stream, name, ',')) {
+                if (!findField(name)) {
+                    std::fprintf(stderr, "unknown config field: %s\n", name.c_str());
+                    return false;
+                }
+                options.params.push_back(name);
+            }
+        } else if (arg == "--sweeps" && i + 1 < argc) {
+            options.sweeps = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--step" && i + 1 < argc) {
+            options.step = std::atof(argv[++i]);
+        } else if (arg == "--min-step" && i + 1 < argc) {
+            options.minStep = std::atof(argv[++i]);
+        } else if (arg == "--kernels" && i + 1 < argc) {
+            std::string kernels = argv[++i];
+            if (kernels != "reference" && kernels != "fast") {
+                std::fprintf(stderr, "unknown kernels: %s\n", kernels.c_str());
+                return false;
+            }
+            options.kernels = kernels == "fast" ? DifficultyKernels::FAST : DifficultyKernels::REFERENCE;
+        } else if (arg == "-h" || arg == "--help") {
+            return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.size() != 1 || options.params.empty() || options.step <= 0.0 || options.minStep <= 0.0) return false;
+    options.labels = positional[0];
+    return true;
+}
+
+// Splits from the right so chart paths may contain commas.
+static bool splitLabel(const std::string& line, std::string fields[4])
+{
+    std::string rest = line;
+    for (int field = 3; field > 0; --field) {
+        size_t comma = rest.rfind(',');
+        if (comma == std::string::npos) return false;
+        fields[field] = rest.substr(comma + 1);
+        rest.resize(comma);
+    }
+    fields[0] = rest;
+    return !fields[0].empty();
+}
+
+static bool loadLabels(const fs::path& labelsPath, DifficultyTuningSet& set, std::vector<std::string>& names)
+{
+    std::string content = Utils::readFile(labelsPath.string());
+    if (content.empty()) {
+        std::fprintf(stderr, "could not read %s\n", labelsPath.string().c_str());
+        return false;
+    }
+
+    std::map<fs::path, std::map<std::string, ChartData>> parsedFiles;
+    std::stringstream stream(content);
+    std::string line;
+    int lineNumber = 0;
+    bool ok = true;
+
+    while (std::getline(stream, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        std::string fields[4];
+        if (!splitLabel(line, fields)) {
+            std::fprintf(stderr, "%s:%d: expected <chart path>,<difficulty>,<rate>,<target>\n", labelsPath.string().c_str(), lineNumber);
+            ok = false;
+            continue;
+        }
+
+        fs::path chartPath = labelsPath.parent_path() / fields[0];
+        auto parsed = parsedFiles.find(chartPath);
+        if (parsed == parsedFiles.end()) {
+            std::string chartContent = Utils::readFile(chartPath.string());
+            parsed = parsedFiles.emplace(chartPath, ChartUtils::parseChartMultiple(chartPath.parent_path().string(), chartPath.string(), chartContent)).first;
+        }
+
+        const std::map<std::string, ChartData>& charts = parsed->second;
+        auto chart = fields[1].empty() && charts.size() == 1 ? charts.begin() : charts.find(fields[1]);
+        if (chart == charts.end()) {
+            std::fprintf(stderr, "%s:%d: no chart \"%s\" in %s\n", labelsPath.string().c_str(), lineNumber, fields[1].c_str(), chartPath.string().c_str());
+            ok = false;
+            continue;
+        }
+
+        float rate = std::strtof(fields[2].c_str(), nullptr);
+        double target = std::strtod(fields[3].c_str(), nullptr);
+        if (!set.add(chart->second, rate, target)) {
+            std::fprintf(stderr, "%s:%d: %s has no notes, skipped\n", labelsPath.string().c_str(), lineNumber, chartPath.string().c_str());
+            continue;
+        }
+        names.push_back(fields[0] + " [" + chart->first + "] " + fields[2] + "x");
+    }
+
+    return ok;
+}
+
+static ErrorMetrics measureErrors(const DifficultyTuningSet& set, const std::vector<double>& ratings)
+{
+    ErrorMetrics metrics;
+    const size_t count = ratings.size();
+    if (count == 0) return metrics;
+
+    double squared = 0.0, absolute = 0.0;
+    double meanRating = 0.0, meanTarget = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double error = ratings[i] - set.getTarget(i);
+        squared += error * error;
+        absolute += std::abs(error);
+        if (std::abs(error) > metrics.maxAbsolute) {
+            metrics.maxAbsolute = std::abs(error);
+            metrics.worstSample = i;
+        }
+        meanRating += ratings[i];
+        meanTarget += set.getTarget(i);
+    }
+    metrics.rmse = std::sqrt(squared / count);
+    metrics.meanAbsolute = absolute / count;
+    meanRating /= count;
+    meanTarget /= count;
+
+    double covariance = 0.0, ratingVariance = 0.0, targetVariance = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double rating = ratings[i] - meanRating;
+        double target = set.getTarget(i) - meanTarget;
+        covariance += rating * target;
+        ratingVariance += rating * rating;
+        targetVariance += target * target;
+    }
+    if (ratingVariance > 0.0 && targetVariance > 0.0) {
+        metrics.correlation = covariance / std::sqrt(ratingVariance * targetVariance);
+    }
+    return metrics;
+}
+
+static void printMetrics(const char* label, const ErrorMetrics& metrics, const std::vector<std::string>& names)
+{
+    std::printf("%-8s rmse %.4f  mae %.4f  max %.4f (%s)  r %.4f\n", label,
+        metrics.rmse, metrics.meanAbsolute, metrics.maxAbsolute,
+        names.empty() ? "-" : names[metrics.worstSample].c_str(), metrics.correlation);
+}
+
+int main(int argc, char** argv)
+{
+    TuneOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    Logger::getInstance().setLogLevel(LogLevel::GAME_ERROR);
+
+    DifficultyTuningSet set(options.kernels);
+    std::vector<std::string> names;
+    if (!loadLabels(options.labels, set, names) || set.size() == 0) {
+        if (set.size() == 0) std::fprintf(stderr, "no usable samples in %s\n", options.labels.string().c_str());
+        Logger::getInstance().shutdown();
+        return 1;
+    }
+
+    const int threads = ToolUtils::resolveThreadCount(options.threads);
+
+    auto prepareStart = std::chrono::steady_clock::now();
+    ToolUtils::parallelFor(set.size(), threads, [&](size_t i) { set.prepare(i); });
+    double prepareSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - prepareStart).count();
+    std::printf("%zu samples, features extracted in %.2fs on %d threads\n", set.size(), prepareSeconds, threads);
+
+    std::vector<double> ratings(set.size());
+    size_t evaluations = 0;
+    auto evaluate = [&](const DifficultyConfig& config) {
+        ToolUtils::parallelFor(set.size(), threads, [&](size_t i) { ratings[i] = set.rate(i, config); });
+        evaluations++;
+        return measureErrors(set, ratings).rmse;
+    };
+
+    const DifficultyConfig initial;
+    DifficultyConfig config = initial;
+
+    auto tuneStart = std::chrono::steady_clock::now();
+    double loss = evaluate(config);
+    printMetrics("initial", measureErrors(set, ratings), names);
+
+    double step = options.step;
+    for (int sweep = 1; sweep <= options.sweeps && step >= options.minStep; ++sweep) {
+        bool improved = false;
+        for (const std::string& name : options.params) {
+            double DifficultyConfig::* member = findField(name)->member;
+            double current = config.*member;
+            double bestValue = current;
+
+            // Relative steps keep every field on its own scale; a zero field
+            // steps by the bare amount instead.
+            for (double direction : {1.0, -1.0}) {
+                DifficultyConfig candidate = config;
+                candidate.*member = current != 0.0 ? current * (1.0 + direction * step) : direction * step;
+                double candidateLoss = evaluate(candidate);
+                if (candidateLoss < loss) {
+                    loss = candidateLoss;
+                    bestValue = candidate.*member;
+                }
+            }
+
+            if (bestValue != current) {
+                config.*member = bestValue;
+                improved = true;
+            }
+        }
+
+        std::printf("sweep %2d  step %.4f  rmse %.4f%s\n", sweep, step, loss, improved ? "" : "  (halving step)");
+        if (!improved) step /= 2.0;
+    }
+
+    double tuneSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tuneStart).count();
+
+    evaluate(config);
+    printMetrics("tuned", measureErrors(set, ratings), names);
+
+    size_t ratingsDone = evaluations * set.size();
+    std::printf("%zu configs, %zu chart ratings in %.2fs: %.0f charts/s\n",
+        evaluations, ratingsDone, tuneSeconds, tuneSeconds > 0 ? ratingsDone / tuneSeconds : 0.0);
+
+    for (const auto& field : CONFIG_FIELDS) {
+        if (config.*field.member != initial.*field.member) {
+            std::printf("%-22s %.6g -> %.6g\n", field.name, initial.*field.member, config.*field.member);
+        }
+    }
+
+    Logger::getInstance().shutdown();
+    return 0;
+}
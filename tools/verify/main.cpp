@@ -0,0 +1,450 @@
+#include <utils/rhythm/ChartUtils.h>
+#include <utils/rhythm/VscBinary.h>
+#include <utils/rhythm/SongLibrary.h>
+#include <utils/rhythm/OsuUtils.h>
+#include <rhythm/DifficultyCalculator.h>
+#include <rhythm/DifficultyEditSession.h>
+#include <utils/Utils.h>
+#include <system/Logger.h>
+#include <common/ToolUtils.h>
+#include <common/ChartEdits.h>
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const std::vector<float> RATES = {0.8f, 1.0f, 1.5f};
+static constexpr size_t EDIT_COUNT = 9;
+
+static const std::vector<std::string> CHART_COLUMNS = {
+    "keyCount", "notes", "taps", "holds", "mines", "timingPoints", "hash", "validation",
+};
+
+static const std::vector<std::string> RESULT_COLUMNS = {
+    "rawDiff", "riceTotal", "lnTotal", "minBPM", "maxBPM",
+    "stream", "jumpstream", "handstream", "jack", "chordjack", "technical", "stamina",
+    "density", "speed", "shields", "complexity",
+};
+
+struct VerifyOptions {
+    fs::path reference;
+    fs::path golden;
+    bool update = false;
+    double tolerance = 0.0;
+};
+
+// One chart at one rate. Parse facts compare as text, ratings as numbers.
+struct GoldenRow {
+    std::string file;
+    std::string difficulty;
+    std::string rate;
+    std::vector<std::string> chart;
+    std::vector<double> results;
+};
+
+static void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: chart-verify <reference-dir> [options]\n"
+        "  Parses every chart under <reference-dir>, rates it at 0.8x, 1.0x and\n"
+        "  1.5x and compares note counts, hashes and every FinalResult field\n"
+        "  against the golden file. Reference kernels, the generic key layout\n"
+        "  and calculateRates must match to --tolerance; fast kernels must stay\n"
+        "  within DifficultyCalculator::FAST_KERNEL_TOLERANCE of the golden\n"
+        "  ratings. VSC and VSCB round trips must keep every chart hash, and a\n"
+        "  DifficultyEditSession fed a fixed run of single-note edits must\n"
+        "  agree with calculate() after each one. LN shields must match the\n"
+        "  pairwise loop the sweep replaced. Charts listed in an osu!.db\n"
+        "  under <reference-dir> are checked again as song select loads them,\n"
+        "  and must agree with their database record.\n"
+        "  Exits 1 on any mismatch. Ratings go through libm, so a golden file\n"
+        "  written by another compiler or platform may need --tolerance.\n"
+        "\n"
+        "  --golden FILE    golden results (default: <reference-dir>/golden.tsv)\n"
+        "  --update         rewrite the golden file from the current build\n"
+        "  --tolerance R    allowed relative drift in ratings (default: 0, exact)\n");
+}
+
+static bool parseArgs(int argc, char** argv, VerifyOptions& options)
+{
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--golden" && i + 1 < argc) {
+            options.golden = argv[++i];
+        } else if (arg == "--update") {
+            options.update = true;
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            options.tolerance = std::atof(argv[++i]);
+        } else if (arg == "-h" || arg == "--help") {
+            return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.size() != 1 || options.tolerance < 0.0) return false;
+    options.reference = positional[0];
+    if (options.golden.empty()) options.golden = options.reference / "golden.tsv";
+    return true;
+}
+
+static std::string formatNumber(double value)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    return buffer;
+}
+
+static std::vector<std::string> describeChart(const ChartData& chart)
+{
+    size_t taps = 0, holds = 0, mines = 0;
+    for (uint8_t type : chart.notes->types()) {
+        if (type == TAP) taps++;
+        else if (type == HOLD_START) holds++;
+        else if (type == MINE) mines++;
+    }
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016" PRIx64, chart.hash);
+
+    return {
+        std::to_string(chart.keyCount), std::to_string(chart.notes->size()),
+        std::to_string(taps), std::to_string(holds), std::to_string(mines),
+        std::to_string(chart.timingPoints.size()), hash, std::to_string(chart.validation.total()),
+    };
+}
+
+static std::vector<double> resultValues(const FinalResult& result)
+{
+    return {
+        result.rawDiff, result.riceTotal, result.lnTotal, result.minBPM, result.maxBPM,
+        result.skills.stream, result.skills.jumpstream, result.skills.handstream, result.skills.jack,
+        result.skills.chordjack, result.skills.technical, result.skills.stamina,
+        result.skills.density, result.skills.speed, result.skills.shields, result.skills.complexity,
+    };
+}
+
+static std::string rowKey(const std::string& file, const std::string& difficulty, const std::string& rate)
+{
+    return file + '\t' + difficulty + '\t' + rate;
+}
+
+static std::vector<std::string> splitTabs(const std::string& line)
+{
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, '\t')) fields.push_back(field);
+    return fields;
+}
+
+static bool loadGolden(const fs::path& path, std::map<std::string, GoldenRow>& rows)
+{
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::fprintf(stderr, "could not read %s (run with --update to create it)\n", path.string().c_str());
+        return false;
+    }
+
+    const size_t columns = 3 + CHART_COLUMNS.size() + RESULT_COLUMNS.size();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#' || line.rfind("file\t", 0) == 0) continue;
+
+        std::vector<std::string> fields = splitTabs(line);
+        if (fields.size() != columns) {
+            std::fprintf(stderr, "%s:%d: expected %zu columns, got %zu\n", path.string().c_str(), lineNumber, columns, fields.size());
+            return false;
+        }
+
+        GoldenRow row;
+        row.file = fields[0];
+        row.difficulty = fields[1];
+        row.rate = fields[2];
+        row.chart.assign(fields.begin() + 3, fields.begin() + 3 + CHART_COLUMNS.size());
+        for (size_t i = 3 + CHART_COLUMNS.size(); i < fields.size(); ++i) {
+            row.results.push_back(std::strtod(fields[i].c_str(), nullptr));
+        }
+        rows[rowKey(row.file, row.difficulty, row.rate)] = std::move(row);
+    }
+    return true;
+}
+
+static bool writeGolden(const fs::path& path, const std::vector<GoldenRow>& rows)
+{
+    std::string out = "# Golden results for chart-verify. Regenerate with --update only when a\n"
+                      "# parser or rating change is intended, and bump ALGORITHM_VERSION for the latter.\n";
+    out += "file\tdifficulty\trate";
+    for (const auto& column : CHART_COLUMNS) out += '\t' + column;
+    for (const auto& column : RESULT_COLUMNS) out += '\t' + column;
+    out += '\n';
+
+    for (const auto& row : rows) {
+        out += row.file + '\t' + row.difficulty + '\t' + row.rate;
+        for (const auto& value : row.chart) out += '\t' + value;
+        for (double value : row.results) out += '\t' + formatNumber(value);
+        out += '\n';
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open() || !file.write(out.data(), out.size())) {
+        std::fprintf(stderr, "could not write %s\n", path.string().c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool withinTolerance(double expected, double actual, double tolerance)
+{
+    if (expected == actual) return true;
+    return std::abs(actual - expected) <= tolerance * std::abs(expected);
+}
+
+// Replays EDIT_COUNT single-note edits through one session and compares
+// each update() with a full calculate() of the edited chart.
+static std::vector<std::string> checkEdits(const ChartData& chart, const DifficultyCalculator& calculator, float rate, double tolerance)
+{
+    std::vector<std::string> problems;
+    DifficultyEditSession session(calculator, rate);
+    session.load(chart);
+
+    ChartData current = chart;
+    for (size_t edit = 0; edit < EDIT_COUNT; ++edit) {
+        ChartEdit edited = ChartEdits::singleNote(current, edit, EDIT_COUNT);
+        std::vector<double> actual = resultValues(session.update(edited.chart, edited.startMs, edited.endMs));
+        std::vector<double> expected = resultValues(calculator.calculate(edited.chart, rate));
+        for (size_t i = 0; i < RESULT_COLUMNS.size(); ++i) {
+            if (!withinTolerance(expected[i], actual[i], tolerance)) {
+                problems.push_back("edit " + std::to_string(edit) + " " + RESULT_COLUMNS[i] + " " + formatNumber(actual[i]) + ", calculate() gives " + formatNumber(expected[i]));
+            }
+        }
+        current = std::move(edited.chart);
+    }
+    return problems;
+}
+
+int main(int argc, char** argv)
+{
+    VerifyOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    Logger::getInstance().setLogLevel(LogLevel::GAME_ERROR);
+
+    const std::vector<std::string> extensions = {".vsc", ".vscb", ".osu", ".sm", ".ssc"};
+    std::vector<fs::path> files = ToolUtils::collectFiles(options.reference, extensions);
+    if (files.empty()) {
+        std::fprintf(stderr, "no charts found under %s\n", options.reference.string().c_str());
+        Logger::getInstance().shutdown();
+        return 1;
+    }
+
+    std::map<std::string, GoldenRow> golden;
+    if (!options.update && !loadGolden(options.golden, golden)) {
+        Logger::getInstance().shutdown();
+        return 1;
+    }
+
+    DifficultyCalculator reference;
+    DifficultyCalculator generic;
+    generic.setSpecializedKeyLayouts(false);
+    DifficultyCalculator fast;
+    fast.setKernels(DifficultyKernels::FAST);
+    DifficultyCalculator pairwise;
+    pairwise.setPairwiseLnShields(true);
+
+    const double fastTolerance = std::max(options.tolerance, DifficultyCalculator::FAST_KERNEL_TOLERANCE);
+    const double shieldsTolerance = std::max(options.tolerance, DifficultyCalculator::LN_SHIELDS_SWEEP_TOLERANCE);
+
+    std::vector<GoldenRow> rows;
+    size_t failures = 0;
+    size_t charts = 0;
+    size_t shieldCharts = 0;
+    auto fail = [&](const GoldenRow& row, const std::string& what) {
+        std::printf("FAIL %s [%s] %sx: %s\n", row.file.c_str(), row.difficulty.c_str(), row.rate.c_str(), what.c_str());
+        failures++;
+    };
+
+    auto verifyChart = [&](const std::string& relative, const std::string& difficultyName, const ChartData& chart) {
+        charts++;
+
+        // Both writers must reproduce the playable content exactly.
+        if (ChartUtils::parseChart("", "roundtrip.vsc", ChartUtils::serializeVsc(chart)).hash != chart.hash) {
+            std::printf("FAIL %s [%s]: hash changed after a VSC round trip\n", relative.c_str(), difficultyName.c_str());
+            failures++;
+        }
+        if (VscBinary::parse(VscBinary::serialize(chart)).hash != chart.hash) {
+            std::printf("FAIL %s [%s]: hash changed after a VSCB round trip\n", relative.c_str(), difficultyName.c_str());
+            failures++;
+        }
+
+        std::vector<FinalResult> laddered = reference.calculateRates(chart, RATES, 1);
+        for (size_t rateIndex = 0; rateIndex < RATES.size(); ++rateIndex) {
+            float rate = RATES[rateIndex];
+            char rateText[16];
+            std::snprintf(rateText, sizeof(rateText), "%g", rate);
+
+            GoldenRow row;
+            row.file = relative;
+            row.difficulty = difficultyName;
+            row.rate = rateText;
+            row.chart = describeChart(chart);
+            row.results = resultValues(reference.calculate(chart, rate));
+
+            for (const std::string& problem : checkEdits(chart, reference, rate, options.tolerance)) {
+                fail(row, "reference edit session " + problem);
+            }
+            for (const std::string& problem : checkEdits(chart, fast, rate, fastTolerance)) {
+                fail(row, "fast edit session " + problem);
+            }
+
+            // The LN shields sweep against the loop it replaced. Every field
+            // is compared so the switch can't leak past shields.
+            FinalResult pairwiseResult = pairwise.calculate(chart, rate);
+            std::vector<double> pairwiseValues = resultValues(pairwiseResult);
+            for (size_t i = 0; i < RESULT_COLUMNS.size(); ++i) {
+                if (!withinTolerance(pairwiseValues[i], row.results[i], shieldsTolerance)) {
+                    fail(row, "shields sweep " + RESULT_COLUMNS[i] + " " + formatNumber(row.results[i]) + ", pairwise loop gives " + formatNumber(pairwiseValues[i]));
+                }
+            }
+            if (rateIndex == 0 && pairwiseResult.skills.shields > 0.0) shieldCharts++;
+
+            if (options.update) {
+                rows.push_back(std::move(row));
+                continue;
+            }
+
+            auto expected = golden.find(rowKey(row.file, row.difficulty, row.rate));
+            if (expected == golden.end()) {
+                fail(row, "not in the golden file");
+                continue;
+            }
+            const GoldenRow want = std::move(expected->second);
+            golden.erase(expected);
+
+            for (size_t i = 0; i < CHART_COLUMNS.size(); ++i) {
+                if (row.chart[i] != want.chart[i]) {
+                    fail(row, CHART_COLUMNS[i] + " " + row.chart[i] + ", expected " + want.chart[i]);
+                }
+            }
+
+            auto compare = [&](const char* mode, const std::vector<double>& actual, double tolerance) {
+                for (size_t i = 0; i < RESULT_COLUMNS.size(); ++i) {
+                    if (!withinTolerance(want.results[i], actual[i], tolerance)) {
+                        fail(row, std::string(mode) + " " + RESULT_COLUMNS[i] + " " + formatNumber(actual[i]) + ", expected " + formatNumber(want.results[i]));
+                    }
+                }
+            };
+            compare("reference", row.results, options.tolerance);
+            compare("generic layout", resultValues(generic.calculate(chart, rate)), options.tolerance);
+            compare("calculateRates", resultValues(laddered[rateIndex]), options.tolerance);
+            compare("fast kernels", resultValues(fast.calculate(chart, rate)), fastTolerance);
+        }
+    };
+
+    for (const auto& path : files) {
+        std::string relative = fs::relative(path, options.reference).generic_string();
+        std::map<std::string, ChartData> parsed = ChartUtils::parseChartMultiple(path.parent_path().string(), path.string(), Utils::readFile(path.string()));
+        if (parsed.empty()) {
+            std::printf("FAIL %s: no charts parsed\n", relative.c_str());
+            failures++;
+            continue;
+        }
+
+        for (const auto& [difficultyName, chart] : parsed) {
+            verifyChart(relative, difficultyName, chart);
+        }
+    }
+
+    // Charts reached through an osu!.db go the way song select takes them: a
+    // deferred stub from the database, loaded on selection. Folders are
+    // relative to the database; records for missing folders must fail to load.
+    for (const auto& database : ToolUtils::collectFiles(options.reference, {".db"})) {
+        std::string relative = fs::relative(database, options.reference).generic_string();
+        SongPack pack;
+        try {
+            pack = SongLibrary::buildOsuPack(OsuUtils::readDatabase(database.string()), database.parent_path().string());
+        } catch (const std::exception& e) {
+            std::printf("FAIL %s: %s\n", relative.c_str(), e.what());
+            failures++;
+            continue;
+        }
+
+        for (auto& song : pack.songs) {
+            for (auto& [difficultyName, chart] : song.difficulties) {
+                if (!fs::exists(chart.filename)) {
+                    // Song select retries these on the next selection.
+                    if (SongLibrary::loadChart(chart) || !chart.deferred) {
+                        std::printf("FAIL %s: loaded a missing chart file\n", chart.filename.c_str());
+                        failures++;
+                    }
+                    continue;
+                }
+
+                std::string name = relative + '#' + fs::relative(chart.filename, database.parent_path()).generic_string();
+                const ChartData stub = chart;
+                if (!SongLibrary::loadChart(chart) || chart.deferred) {
+                    std::printf("FAIL %s: could not load\n", name.c_str());
+                    failures++;
+                    continue;
+                }
+
+                auto mismatch = [&](const char* field, const std::string& fromDatabase, const std::string& fromChart) {
+                    if (fromDatabase == fromChart) return;
+                    std::printf("FAIL %s [%s]: database %s \"%s\", chart has \"%s\"\n",
+                        name.c_str(), difficultyName.c_str(), field, fromDatabase.c_str(), fromChart.c_str());
+                    failures++;
+                };
+                mismatch("keyCount", std::to_string(stub.keyCount), std::to_string(chart.keyCount));
+                mismatch("timingPoints", std::to_string(stub.timingPoints.size()), std::to_string(chart.timingPoints.size()));
+                mismatch("title", stub.metadata.title, chart.metadata.title);
+                mismatch("artist", stub.metadata.artist, chart.metadata.artist);
+                mismatch("difficulty", stub.metadata.difficulty, chart.metadata.difficulty);
+                // Search filters go by the listed length until the chart loads.
+                float lastNote = chart.notes->empty() ? 0.0f : chart.notes->times().back();
+                mismatch("length", std::to_string(std::lround(stub.deferredLengthMs)), std::to_string(std::lround(lastNote)));
+
+                verifyChart(name, difficultyName, chart);
+            }
+        }
+    }
+
+    // Both shields paths return 0 on charts without holds around rice.
+    if (shieldCharts == 0) {
+        std::printf("FAIL %s: no chart scores any LN shields\n", options.reference.string().c_str());
+        failures++;
+    }
+
+    if (options.update) {
+        bool written = writeGolden(options.golden, rows);
+        if (written) std::printf("wrote %zu rows for %zu charts to %s\n", rows.size(), charts, options.golden.string().c_str());
+        Logger::getInstance().shutdown();
+        return written && failures == 0 ? 0 : 1;
+    }
+
+    for (const auto& [key, row] : golden) {
+        fail(row, "in the golden file but not under " + options.reference.string());
+    }
+
+    std::printf("%zu charts at %zu rates: %s\n", charts, RATES.size(),
+        failures == 0 ? "all match" : (std::to_string(failures) + " mismatch(es)").c_str());
+
+    Logger::getInstance().shutdown();
+    return failures == 0 ? 0 : 1;
+}